@@ -0,0 +1,270 @@
+#ifndef LMS_BUFFER_POOL_H
+#define LMS_BUFFER_POOL_H
+
+#include <atomic>
+#include <memory>
+#include <typeinfo>
+#include <utility>
+#include <cstddef>
+#include <functional>
+#include "lms/extra/bounded_queue.h"
+
+namespace lms {
+
+template<typename T>
+class BufferPool;
+
+namespace internal {
+
+template<typename T>
+class PoolStorage;
+
+template<typename T>
+struct PoolSlot {
+    PoolSlot() : refs(0), storage(nullptr), pooled(true) {}
+
+    std::atomic<int> refs;
+    T value;
+    PoolStorage<T> *storage;
+
+    /**
+     * @brief false if the slot was allocated because the pool was exhausted
+     */
+    bool pooled;
+};
+
+/**
+ * @brief Buffers of a BufferPool. Lives as long as the pool or any buffer
+ * that was handed out is alive.
+ */
+template<typename T>
+class PoolStorage {
+public:
+    PoolStorage(std::size_t size, std::function<void(T&)> init)
+        : m_size(size), m_slots(new PoolSlot<T>[size]), m_free(size), m_init(init),
+          m_refs(1), m_overflows(0) {
+        for(std::size_t i = 0; i < size; i++) {
+            m_slots[i].storage = this;
+            if(m_init) {
+                m_init(m_slots[i].value);
+            }
+            m_free.push(&m_slots[i]);
+        }
+    }
+
+    PoolSlot<T>* acquire() {
+        PoolSlot<T> *slot;
+        if(! m_free.pop(slot)) {
+            slot = new PoolSlot<T>;
+            slot->storage = this;
+            slot->pooled = false;
+            if(m_init) {
+                m_init(slot->value);
+            }
+            m_overflows.fetch_add(1, std::memory_order_relaxed);
+        }
+        slot->refs.store(1, std::memory_order_relaxed);
+        m_refs.fetch_add(1, std::memory_order_relaxed);
+        return slot;
+    }
+
+    /**
+     * @brief Called when the last reference to a slot was dropped.
+     */
+    void release(PoolSlot<T> *slot) {
+        if(slot->pooled) {
+            m_free.push(slot);
+        } else {
+            delete slot;
+        }
+        unref();
+    }
+
+    void unref() {
+        if(m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete this;
+        }
+    }
+
+    std::size_t size() const {
+        return m_size;
+    }
+
+    std::size_t available() const {
+        return m_free.sizeApprox();
+    }
+
+    std::size_t overflows() const {
+        return m_overflows.load(std::memory_order_relaxed);
+    }
+private:
+    std::size_t m_size;
+    std::unique_ptr<PoolSlot<T>[]> m_slots;
+    extra::BoundedQueue<PoolSlot<T>*> m_free;
+    std::function<void(T&)> m_init;
+    std::atomic<int> m_refs;
+    std::atomic<std::size_t> m_overflows;
+};
+
+}  // namespace internal
+
+/**
+ * @brief Reference counted handle to a buffer of a BufferPool.
+ *
+ * Copies refer to the same buffer. When the last handle is destroyed, the
+ * buffer goes back to its pool, keeping all memory it allocated. The
+ * reference count is stored next to the buffer, so copying a handle never
+ * allocates memory.
+ *
+ * Handles can be used as data channel values and as queue channel items.
+ */
+template<typename T>
+class PooledBuffer {
+public:
+    PooledBuffer() : m_slot(nullptr) {}
+
+    PooledBuffer(const PooledBuffer &other) : m_slot(other.m_slot) {
+        if(m_slot != nullptr) {
+            m_slot->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    PooledBuffer(PooledBuffer &&other) noexcept : m_slot(other.m_slot) {
+        other.m_slot = nullptr;
+    }
+
+    PooledBuffer& operator=(const PooledBuffer &other) {
+        PooledBuffer(other).swap(*this);
+        return *this;
+    }
+
+    PooledBuffer& operator=(PooledBuffer &&other) noexcept {
+        PooledBuffer(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~PooledBuffer() {
+        reset();
+    }
+
+    /**
+     * @brief Drop the reference to the buffer.
+     */
+    void reset() {
+        if(m_slot != nullptr &&
+                m_slot->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            m_slot->storage->release(m_slot);
+        }
+        m_slot = nullptr;
+    }
+
+    void swap(PooledBuffer &other) noexcept {
+        std::swap(m_slot, other.m_slot);
+    }
+
+    T* get() const {
+        return m_slot != nullptr ? &m_slot->value : nullptr;
+    }
+
+    T& operator*() const {
+        return m_slot->value;
+    }
+
+    T* operator->() const {
+        return &m_slot->value;
+    }
+
+    explicit operator bool() const {
+        return m_slot != nullptr;
+    }
+
+    /**
+     * @brief Number of handles that refer to the same buffer.
+     */
+    int useCount() const {
+        return m_slot != nullptr ? m_slot->refs.load(std::memory_order_relaxed) : 0;
+    }
+private:
+    explicit PooledBuffer(internal::PoolSlot<T> *slot) : m_slot(slot) {}
+
+    friend class BufferPool<T>;
+
+    internal::PoolSlot<T> *m_slot;
+};
+
+/**
+ * @brief Type independent base of BufferPool.
+ */
+class BufferPoolBase {
+public:
+    virtual ~BufferPoolBase() {}
+    virtual std::size_t hashCode() const = 0;
+    virtual std::size_t size() const = 0;
+    virtual std::size_t available() const = 0;
+    virtual std::size_t overflows() const = 0;
+};
+
+/**
+ * @brief A fixed number of preallocated buffers that are recycled instead
+ * of being freed.
+ *
+ * Writers acquire a buffer, fill it and write the handle into a channel.
+ * The buffer returns to the pool as soon as no channel and no module holds
+ * a handle to it anymore. Buffers keep their contents (and the capacity of
+ * any containers) when they are recycled.
+ *
+ * If all buffers are in use, acquire() allocates an additional buffer that
+ * is freed instead of being recycled, see overflows().
+ *
+ * acquire() and the release of buffers are thread-safe.
+ */
+template<typename T>
+class BufferPool : public BufferPoolBase {
+public:
+    /**
+     * @param size number of buffers
+     * @param init called once for each new buffer, e.g. to reserve memory
+     */
+    explicit BufferPool(std::size_t size, std::function<void(T&)> init = nullptr)
+        : m_storage(new internal::PoolStorage<T>(size, init)) {}
+
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    ~BufferPool() {
+        m_storage->unref();
+    }
+
+    PooledBuffer<T> acquire() {
+        return PooledBuffer<T>(m_storage->acquire());
+    }
+
+    std::size_t hashCode() const override {
+        return typeid(T).hash_code();
+    }
+
+    std::size_t size() const override {
+        return m_storage->size();
+    }
+
+    /**
+     * @brief Number of buffers that are currently not in use.
+     */
+    std::size_t available() const override {
+        return m_storage->available();
+    }
+
+    /**
+     * @brief Number of buffers that had to be allocated because the pool
+     * was exhausted.
+     */
+    std::size_t overflows() const override {
+        return m_storage->overflows();
+    }
+private:
+    internal::PoolStorage<T> *m_storage;
+};
+
+}  // namespace lms
+
+#endif // LMS_BUFFER_POOL_H
@@ -29,6 +29,26 @@ public:
         return m_internal->name;
     }
 
+    /**
+     * @brief Cycle in which the channel was written the last time.
+     *
+     * A cycle counts as write access if a module called get() (or -> or *)
+     * on a WriteDataChannel in that cycle or if new data was received from
+     * another runtime or process at the beginning of the cycle.
+     *
+     * @return cycle number or -1 if the channel was never written
+     */
+    int lastWriteCycle() const {
+        return m_internal->getCycle();
+    }
+
+    /**
+     * @brief Time of the first write access in lastWriteCycle().
+     */
+    Time lastWriteTime() const {
+        return m_internal->writeTime;
+    }
+
 
     /**
      * return returns SUBTYPE if the current object is a subtype of the given one
@@ -104,38 +124,39 @@ public:
 
     ReadDataChannel(std::shared_ptr<internal::DataChannelInternal> internal) :
         DataChannel<T>(internal) {}
+
     /**
-     * @brief get returns the contained object, if you have a lms::Void type, use getVoid()
+     * @brief get returns the contained object, if you have a lms::Any type, use getWithType()
+     *
+     * If the channel is imported from another runtime this is the latest
+     * snapshot that was received at the beginning of the current cycle.
      * @return
      */
-    /*
-    const T* get() {
-        //Handle lms::Void pointer
-        if(std::is_same<T, Void>::value){
-            return nullptr;
-        }
-        return static_cast<const T*>(this->m_internal->main->get());
-
-        // TODO buffer
-        if(this->m_internal->buffered()){
-            if(this->m_internal->m_buffer.size() > 0)
-                return this->m_internal->m_buffer[this->m_internal->m_buffer.size() -1];
-            else
-                return nullptr;
-        }else{
-
-        }
-    }
-    */
     const T* get() {
+        this->m_internal->countRead();
         return this->get_();
     }
 
     template <typename A>
     const A* getWithType() {
+        this->m_internal->countRead();
         return DataChannel<T>::template getWithType_<A>();
     }
 
+    /**
+     * @brief Check if the channel was written after the given cycle.
+     *
+     * Writers are always executed before readers, so
+     * changedSince(cycleOfMyLastRun) tells if there is data that the
+     * module has not seen yet.
+     *
+     * @param cycle cycle number, e.g. from Module::cycleCounter()
+     * @return true if the last write access was after the given cycle
+     */
+    bool changedSince(int cycle) const {
+        return this->m_internal->getCycle() > cycle;
+    }
+
     const T* operator ->() {
         return this->get();
     }
@@ -154,16 +175,17 @@ public:
     WriteDataChannel() : DataChannel<T>(nullptr) {}
 
     T* get() {
+        this->m_internal->stampWrite();
         return this->get_();
     }
 
     template <typename A>
     A* getWithType() {
+        this->m_internal->stampWrite();
         return DataChannel<T>::template getWithType_<A>();
     }
 
     T* operator ->(){
-        //m_cycle = maintainer->cycleCount();
         return this->get();
     }
 
@@ -173,6 +195,7 @@ public:
 
     bool deserialize(std::istream &is) {
         if(this->m_internal->main && this->m_internal->main->isSerializable()) {
+            this->m_internal->stampWrite();
             Serializable *data = this->m_internal->main->getSerializable();
             data->lmsDeserialize(is);
             return true;
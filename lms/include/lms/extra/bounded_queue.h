@@ -0,0 +1,201 @@
+#ifndef LMS_EXTRA_BOUNDED_QUEUE_H
+#define LMS_EXTRA_BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace lms {
+namespace extra {
+
+/**
+ * @brief Lock-free queue with a fixed capacity.
+ *
+ * Any number of threads may push and pop concurrently (Dmitry Vyukov's
+ * bounded MPMC queue). If only one thread pushes at a time, the queue can be
+ * switched into single producer mode which replaces the compare-and-swap of
+ * push() with a plain store.
+ *
+ * All slots are allocated and default constructed in the constructor, push()
+ * and pop() never allocate memory (apart from T's own assignment operators).
+ */
+template<typename T>
+class BoundedQueue {
+public:
+    /**
+     * @param capacity maximum number of items, rounded up to the next power
+     * of two
+     */
+    explicit BoundedQueue(std::size_t capacity) : m_singleProducer(false) {
+        std::size_t size = 2;
+        while(size < capacity) {
+            size *= 2;
+        }
+
+        m_mask = size - 1;
+        m_cells.reset(new Cell[size]);
+        for(std::size_t i = 0; i < size; i++) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        m_enqueuePos.store(0, std::memory_order_relaxed);
+        m_dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    /**
+     * @brief Enable the single producer fast path. Must not be changed while
+     * another thread pushes.
+     */
+    void singleProducer(bool enable) {
+        m_singleProducer = enable;
+    }
+
+    bool singleProducer() const {
+        return m_singleProducer;
+    }
+
+    std::size_t capacity() const {
+        return m_mask + 1;
+    }
+
+    /**
+     * @brief Number of items in the queue, only exact if no other thread
+     * pushes or pops at the same time.
+     */
+    std::size_t sizeApprox() const {
+        std::size_t enq = m_enqueuePos.load(std::memory_order_relaxed);
+        std::size_t deq = m_dequeuePos.load(std::memory_order_relaxed);
+        return enq > deq ? enq - deq : 0;
+    }
+
+    /**
+     * @brief Append an item.
+     * @return false if the queue is full
+     */
+    bool push(const T &item) {
+        std::size_t pos;
+        Cell *cell = acquireTail(pos);
+        if(cell == nullptr) {
+            return false;
+        }
+        cell->data = item;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool push(T &&item) {
+        std::size_t pos;
+        Cell *cell = acquireTail(pos);
+        if(cell == nullptr) {
+            return false;
+        }
+        cell->data = std::move(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest item.
+     * @return false if the queue is empty
+     */
+    bool pop(T &item) {
+        std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        Cell *cell;
+
+        for(;;) {
+            cell = &m_cells[pos & m_mask];
+            std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) -
+                    static_cast<std::intptr_t>(pos + 1);
+
+            if(diff == 0) {
+                if(m_dequeuePos.compare_exchange_weak(pos, pos + 1,
+                                                      std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if(diff < 0) {
+                return false;
+            } else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        item = std::move(cell->data);
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove up to max items and append them to the given vector.
+     * @return number of removed items
+     */
+    std::size_t popAll(std::vector<T> &items,
+                       std::size_t max = std::numeric_limits<std::size_t>::max()) {
+        std::size_t count = 0;
+        T item;
+        while(count < max && pop(item)) {
+            items.push_back(std::move(item));
+            count++;
+        }
+        return count;
+    }
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T data;
+    };
+
+    /**
+     * @brief Reserve the next free cell for writing.
+     * @param pos position of the reserved cell
+     * @return nullptr if the queue is full
+     */
+    Cell* acquireTail(std::size_t &pos) {
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+
+        for(;;) {
+            Cell *cell = &m_cells[pos & m_mask];
+            std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            std::intptr_t diff = static_cast<std::intptr_t>(seq) -
+                    static_cast<std::intptr_t>(pos);
+
+            if(diff == 0) {
+                if(m_singleProducer) {
+                    m_enqueuePos.store(pos + 1, std::memory_order_relaxed);
+                    return cell;
+                }
+                if(m_enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                                      std::memory_order_relaxed)) {
+                    return cell;
+                }
+            } else if(diff < 0) {
+                return nullptr;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::unique_ptr<Cell[]> m_cells;
+    std::size_t m_mask;
+    bool m_singleProducer;
+
+    // producer and consumer positions on separate cache lines
+    char m_pad0[64];
+    std::atomic<std::size_t> m_enqueuePos;
+    char m_pad1[64 - sizeof(std::atomic<std::size_t>)];
+    std::atomic<std::size_t> m_dequeuePos;
+    char m_pad2[64 - sizeof(std::atomic<std::size_t>)];
+};
+
+}  // namespace extra
+}  // namespace lms
+
+#endif // LMS_EXTRA_BOUNDED_QUEUE_H
@@ -0,0 +1,71 @@
+#ifndef LMS_EXTRA_LATENCY_HISTOGRAM_H
+#define LMS_EXTRA_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace lms {
+namespace extra {
+
+/**
+ * @brief Histogram of durations in microseconds with a fixed memory
+ * footprint.
+ *
+ * Values below 16 are counted exactly, larger values fall into eight
+ * buckets per power of two, so percentiles are accurate to 12.5%. Min, max
+ * and mean are exact.
+ *
+ * Recording is O(1) and never allocates memory. This class is not
+ * thread-safe.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    /**
+     * @brief Count a duration, negative values are counted as 0.
+     */
+    void record(std::int64_t micros);
+
+    /**
+     * @brief Add all values of another histogram.
+     */
+    void merge(LatencyHistogram const& other);
+
+    void reset();
+
+    std::uint64_t count() const;
+
+    std::int64_t min() const;
+
+    std::int64_t max() const;
+
+    double mean() const;
+
+    /**
+     * @brief Value below which the given fraction of all values lie.
+     * @param fraction between 0 and 1, e.g. 0.99
+     * @return upper bound of the bucket, at most max(), 0 if empty
+     */
+    std::int64_t percentile(double fraction) const;
+private:
+    static constexpr int LINEAR = 16;
+    static constexpr int SUB_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr int BUCKETS = LINEAR + (63 - 4) * SUB_BUCKETS;
+
+    static int bucketOf(std::uint64_t value);
+    static std::uint64_t upperBound(int bucket);
+
+    std::array<std::uint64_t, BUCKETS> m_buckets;
+    std::uint64_t m_count;
+    std::int64_t m_min;
+    std::int64_t m_max;
+    double m_sum;
+};
+
+}  // namespace extra
+}  // namespace lms
+
+#endif // LMS_EXTRA_LATENCY_HISTOGRAM_H
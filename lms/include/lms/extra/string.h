@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
 
 namespace lms {
 namespace extra {
@@ -75,6 +76,14 @@ bool endsWith(std::string const& str, std::string const& suffix);
 
 std::string versionCodeToString(uint32_t versionCode);
 
+/**
+ * @brief Hash a string in a way that is equal across processes and
+ * binaries (FNV-1a), unlike std::hash.
+ * @param str string to hash
+ * @return 64 bit hash
+ */
+std::uint64_t stableHash(std::string const& str);
+
 /**
  * @brief Return the length of a string literal.
  *
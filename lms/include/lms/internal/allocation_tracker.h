@@ -0,0 +1,64 @@
+#ifndef LMS_INTERNAL_ALLOCATION_TRACKER_H
+#define LMS_INTERNAL_ALLOCATION_TRACKER_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace lms {
+namespace internal {
+
+/**
+ * @brief Count heap allocations per thread.
+ *
+ * If liblmscore is built with the CMake option LMS_ALLOCATION_TRACKING,
+ * the global operator new and delete are replaced by versions that forward
+ * to malloc and free and, if the calling thread has counters attached,
+ * count into them. Without attached counters the overhead is a
+ * thread-local load and a branch.
+ *
+ * The option is off by default because the replacement applies to the
+ * whole process: it takes precedence over operators of other allocators
+ * such as tcmalloc or jemalloc and over sanitizers that hook operator new,
+ * and every allocation pays the extra branch even if --allocations is not
+ * given. It is not available on Windows, where a replacement in a DLL does
+ * not affect other DLLs.
+ *
+ * Allocations with malloc or of over-aligned types are not counted.
+ */
+class AllocationTracker {
+public:
+    struct Counters {
+        Counters() : allocations(0), bytes(0), frees(0) {}
+
+        std::uint64_t allocations;
+        std::uint64_t bytes;
+        std::uint64_t frees;
+
+        Counters& operator +=(Counters const& other);
+    };
+
+    /**
+     * @brief Check if operator new is replaced, i.e. liblmscore was built
+     * with LMS_ALLOCATION_TRACKING on a supported platform.
+     */
+    static bool supported();
+
+    /**
+     * @brief Count all further allocations of the calling thread into the
+     * given counters.
+     * @param counters nullptr to stop counting
+     * @return the previously attached counters
+     */
+    static Counters* attach(Counters *counters);
+
+    /**
+     * @brief Called by the replaced operators.
+     */
+    static void allocated(std::size_t size);
+    static void freed();
+};
+
+}  // namespace internal
+}  // namespace lms
+
+#endif // LMS_INTERNAL_ALLOCATION_TRACKER_H
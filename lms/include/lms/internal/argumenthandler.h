@@ -6,6 +6,7 @@
 #include <iostream>
 
 #include "lms/logger.h"
+#include "profiler.h"
 #include "tclap/CmdLine.h"
 
 namespace lms {
@@ -80,6 +81,7 @@ class ArgumentHandler {
     std::string argUser;
     std::vector<std::string> argFlags;
     std::string argProfilingFile;
+    std::string argProfilingFormat;
     bool argMultithreaded;
     bool argThreadsAuto;
     int argThreads;
@@ -91,6 +93,16 @@ class ArgumentHandler {
     std::string argEnableSaveTag;
     bool argEnableDebugServer;
     std::string argDebugServerBind;
+    Profiler::Level argProfilingLevel;
+    std::uint32_t argProfilingSample;
+    bool argChannelStats;
+    bool argHistograms;
+    bool argPerfCounters;
+    bool argCpuTime;
+    bool argAllocations;
+    std::string argSamplingFile;
+    int argSamplingRate;
+    std::string argAsyncLogging;
     std::string configPath;
 private:
     std::string slug(std::string const& tag);
@@ -1,6 +1,8 @@
 #ifndef LMS_INTERNAL_BACKTRACE_FORMATTER_H
 #define LMS_INTERNAL_BACKTRACE_FORMATTER_H
 
+#include <string>
+
 namespace lms {
 namespace internal {
 
@@ -9,6 +11,25 @@ namespace internal {
  */
 void printStacktrace();
 
+/**
+ * @brief Capture the return addresses of the current stack, innermost
+ * frame first.
+ *
+ * Does not allocate memory once it was called the first time, so it may be
+ * used in signal handlers after a warm-up call.
+ *
+ * @param frames output array
+ * @param max size of the output array
+ * @return number of captured frames
+ */
+int captureStacktrace(void **frames, int max);
+
+/**
+ * @brief Demangled name of the function containing the given address, or
+ * the binary and address if no symbol is known.
+ */
+std::string frameName(void *address);
+
 }  // namespace internal
 }  // namespace lms
 
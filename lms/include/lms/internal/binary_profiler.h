@@ -0,0 +1,178 @@
+#ifndef LMS_INTERNAL_BINARY_PROFILER_H
+#define LMS_INTERNAL_BINARY_PROFILER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <fstream>
+#include <condition_variable>
+#include <cstdint>
+
+#include "profiler.h"
+#include "thread_slot.h"
+#include "lms/extra/bounded_queue.h"
+
+namespace lms {
+namespace internal {
+
+/**
+ * @brief Profiling listener that writes compact binary records.
+ *
+ * Each thread that reports markers gets its own ring of fixed-size records,
+ * so onMarker() neither locks nor formats text. Labels are written by id.
+ * A background thread drains all rings every few milliseconds and appends
+ * the records to the file.
+ * Counters share the rings with the markers. Both are dropped (and
+ * counted) if a ring is full.
+ *
+ * File format, all integers in host byte order:
+ *
+ * ~~~
+ * header:  "LMSPROF" '\0', uint32 version, uint32 endianness marker 0x01020304
+ * entries: uint8 type followed by
+ *   BEGIN, END:    int64 micros, uint32 label, uint32 thread, int32 cycle
+ *   MAPPING:       uint32 label, uint16 length, label bytes
+ *   CHANNEL_STATS: int64 micros, uint32 label, uint64 reads, writes, bytes,
+ *                  blocked micros
+ *   COUNTER:       int64 micros, uint32 label, uint32 thread, int32 cycle,
+ *                  int64 value
+ * ~~~
+ *
+ * Threads are numbered in the order of their first marker. Entries of
+ * different threads are not sorted by time.
+ */
+class BinaryProfiler : public Profiler::ProfilingListener {
+public:
+    static constexpr std::uint32_t VERSION = 2;
+    static constexpr std::size_t RING_CAPACITY = 4096;
+
+    /**
+     * @brief Open the file and start the drain thread.
+     */
+    explicit BinaryProfiler(std::string const& file);
+
+    /**
+     * @brief Stop the drain thread and write all remaining records.
+     */
+    ~BinaryProfiler();
+
+    void onLabel(Profiler::LabelId id, std::string const& label) override;
+    void onMarker(Profiler::Type type, lms::Time now, Profiler::LabelId id,
+                  std::string const& label) override;
+    void onChannelStats(lms::Time now, Profiler::LabelId id, std::string const& label,
+                        ChannelStats::Values const& values) override;
+    void onCounter(lms::Time now, Profiler::LabelId id, std::string const& label,
+                   std::int64_t value) override;
+
+    /**
+     * @brief Number of markers and counters that were dropped because a
+     * ring was full.
+     */
+    std::uint64_t dropped() const;
+
+    /**
+     * @brief Write all queued records to the file now.
+     */
+    void flush();
+
+    struct Record {
+        std::int64_t micros;
+        std::uint32_t label;
+        std::uint32_t thread;
+        std::int32_t cycle;
+        std::uint8_t type;
+        /* only used by COUNTER */
+        std::int64_t value;
+    };
+private:
+    struct Ring {
+        Ring(std::uint32_t thread) : thread(thread), records(RING_CAPACITY) {
+            records.singleProducer(true);
+        }
+
+        std::uint32_t thread;
+        extra::BoundedQueue<Record> records;
+    };
+
+    struct Stats {
+        Record record;
+        ChannelStats::Values values;
+    };
+
+    Ring& ring();
+    void drainLoop();
+    void drain();
+
+    /* ring of the calling thread */
+    ThreadSlot<Ring*, BinaryProfiler> m_ring;
+
+    std::ofstream m_stream;
+
+    /* all rings and label names, protected by m_mutex */
+    std::vector<std::unique_ptr<Ring>> m_rings;
+    std::vector<std::string> m_labels;
+    std::vector<Stats> m_stats;
+    std::mutex m_mutex;
+
+    /* serializes file writes of the drain thread and flush() */
+    std::mutex m_drainMutex;
+    std::size_t m_writtenLabels;
+    std::vector<Record> m_drained;
+    std::vector<Stats> m_drainedStats;
+
+    std::atomic<std::uint64_t> m_dropped;
+    bool m_running;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
+
+/**
+ * @brief Read a file that was written by BinaryProfiler.
+ */
+class BinaryProfileReader {
+public:
+    struct Entry {
+        Profiler::Type type;
+        lms::Time time;
+        std::uint32_t label;
+        std::uint32_t thread;
+        std::int32_t cycle;
+        ChannelStats::Values values;
+        /* value of a COUNTER */
+        std::int64_t value;
+    };
+
+    /**
+     * @brief Open the file and check its header.
+     * @return false if the file is missing or has another format
+     */
+    bool open(std::string const& file);
+
+    /**
+     * @brief Read the next marker, channel stats or counter entry. MAPPING entries
+     * are consumed and can be looked up with label().
+     * @return false at the end of the file
+     */
+    bool next(Entry &entry);
+
+    /**
+     * @brief Name of a label id that was read so far.
+     */
+    std::string label(std::uint32_t id) const;
+private:
+    template<typename T>
+    bool read(T &value) {
+        return static_cast<bool>(m_stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    std::ifstream m_stream;
+    std::vector<std::string> m_labels;
+};
+
+}  // namespace internal
+}  // namespace lms
+
+#endif // LMS_INTERNAL_BINARY_PROFILER_H
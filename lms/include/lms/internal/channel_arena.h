@@ -0,0 +1,121 @@
+#ifndef LMS_INTERNAL_CHANNEL_ARENA_H
+#define LMS_INTERNAL_CHANNEL_ARENA_H
+
+#include <map>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+
+namespace lms {
+namespace internal {
+
+/**
+ * @brief Memory for the data channel values of a single runtime.
+ *
+ * Values are placed contiguously into large chunks. Every value starts on
+ * its own cache line and is padded to a multiple of the cache line size, so
+ * channels written by different threads never share a cache line.
+ * Released memory is kept in free lists per padded size and reused for new
+ * values of that size. Chunks are returned to the system when the arena is
+ * destroyed.
+ *
+ * Only the channel value itself lives in the arena, memory that is
+ * allocated by the value (e.g. the elements of a std::vector) does not.
+ *
+ * All methods are thread-safe.
+ */
+class ChannelArena {
+public:
+    static constexpr std::size_t CACHE_LINE = 64;
+    static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+    static constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    ChannelArena();
+    ~ChannelArena();
+
+    ChannelArena(const ChannelArena &) = delete;
+    ChannelArena &operator=(const ChannelArena &) = delete;
+
+    /**
+     * @brief Map new chunks on huge pages. Falls back to normal pages if
+     * the system has no huge pages available. Chunks that were mapped
+     * before are not affected.
+     */
+    void hugePages(bool enable);
+
+    bool hugePages() const;
+
+    /**
+     * @brief Allocate uninitialized memory.
+     *
+     * @param size number of bytes
+     * @param alignment required alignment, at most CACHE_LINE
+     * @return pointer to the memory or nullptr if the alignment is not
+     * supported or no memory could be mapped
+     */
+    void* allocate(std::size_t size, std::size_t alignment);
+
+    /**
+     * @brief Release memory that was returned by allocate().
+     *
+     * @param ptr pointer returned by allocate()
+     * @param size the same size that was given to allocate()
+     */
+    void deallocate(void *ptr, std::size_t size);
+
+    /**
+     * @brief Find the chunk that contains the given pointer.
+     *
+     * @param ptr pointer returned by allocate()
+     * @param chunk index of the chunk
+     * @param offset offset of ptr in the chunk
+     * @return false if the pointer was not allocated by this arena
+     */
+    bool locate(const void *ptr, std::size_t &chunk, std::size_t &offset) const;
+
+    /**
+     * @brief Number of bytes that are allocated, including padding.
+     */
+    std::size_t bytesUsed() const;
+
+    /**
+     * @brief Number of bytes that are mapped from the system.
+     */
+    std::size_t bytesMapped() const;
+
+    std::size_t chunkCount() const;
+
+    /**
+     * @brief Number of chunks that are actually backed by huge pages.
+     */
+    std::size_t hugePageChunkCount() const;
+
+    /**
+     * @brief Size rounded up to the next multiple of the cache line size.
+     */
+    static std::size_t paddedSize(std::size_t size);
+private:
+    struct Chunk {
+        unsigned char *memory;
+        std::size_t size;
+        std::size_t used;
+        bool hugePages;
+    };
+
+    /**
+     * @brief Map a new chunk that has at least minSize bytes.
+     * @return false if the mapping failed
+     */
+    bool mapChunk(std::size_t minSize);
+
+    mutable std::mutex m_mutex;
+    std::vector<Chunk> m_chunks;
+    std::map<std::size_t, std::vector<void*>> m_free;
+    std::size_t m_used;
+    bool m_hugePages;
+};
+
+}  // namespace internal
+}  // namespace lms
+
+#endif // LMS_INTERNAL_CHANNEL_ARENA_H
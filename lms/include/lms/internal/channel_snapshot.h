@@ -0,0 +1,83 @@
+#ifndef LMS_INTERNAL_CHANNEL_SNAPSHOT_H
+#define LMS_INTERNAL_CHANNEL_SNAPSHOT_H
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+#include "data_channel_internal.h"
+
+namespace lms {
+namespace internal {
+
+/**
+ * @brief Lock-free handoff of data channel values between two runtimes.
+ *
+ * The snapshot is a triple buffer: the producing runtime copies its channel
+ * into a private back buffer at the end of its cycle and swaps it with the
+ * shared middle buffer. The consuming runtime swaps the middle buffer into
+ * its private front buffer at the beginning of its cycle if a newer snapshot
+ * was published. Neither side ever waits for the other one.
+ *
+ * There must be exactly one producer thread and one consumer thread.
+ */
+class ChannelSnapshot {
+public:
+    ChannelSnapshot();
+
+    /**
+     * @brief Copy the given object into the back buffer and make it
+     * available to the consumer.
+     *
+     * Must only be called by the producer.
+     *
+     * @param source current channel value of the producer
+     * @param provenance origin of the value, handed over with it
+     * @return false if the value could not be copied (types differ or the
+     * type is not copy assignable)
+     */
+    bool publish(ObjectBase &source, Provenance const& provenance = Provenance());
+
+    /**
+     * @brief Fetch the newest published snapshot.
+     *
+     * Must only be called by the consumer.
+     *
+     * @return true if a newer snapshot than the last one is now available
+     * via front()
+     */
+    bool update();
+
+    /**
+     * @brief The snapshot that was fetched by the last successful update().
+     *
+     * Must only be called by the consumer after update() returned true at
+     * least once.
+     */
+    const ObjectBase& front() const;
+
+    /**
+     * @brief Origin of the value returned by front().
+     */
+    Provenance const& frontProvenance() const;
+private:
+    static constexpr std::uint8_t INDEX_MASK = 0x3;
+    static constexpr std::uint8_t FRESH = 0x4;
+
+    std::unique_ptr<ObjectBase> m_slots[3];
+    Provenance m_provenance[3];
+
+    /**
+     * @brief index of the middle buffer, FRESH is set if the producer
+     * published a snapshot that was not yet taken by the consumer
+     */
+    std::atomic<std::uint8_t> m_middle;
+
+    std::uint8_t m_back;
+    std::uint8_t m_front;
+};
+
+}  // namespace internal
+}  // namespace lms
+
+#endif // LMS_INTERNAL_CHANNEL_SNAPSHOT_H
@@ -0,0 +1,151 @@
+#ifndef LMS_INTERNAL_CHANNEL_STATS_H
+#define LMS_INTERNAL_CHANNEL_STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace lms {
+namespace internal {
+
+/**
+ * @brief Access counters of a single data channel, only allocated if
+ * channel statistics are enabled (--channel-stats).
+ *
+ * The counters are incremented by the channel handles and may be touched
+ * by several module threads at once. They are collected and reset by the
+ * data manager at the end of each cycle.
+ */
+class ChannelStats {
+public:
+    struct Values {
+        Values() : reads(0), writes(0), bytes(0), blockedMicros(0) {}
+
+        /**
+         * @brief number of read accesses (get(), ->, *, pop)
+         */
+        std::uint64_t reads;
+
+        /**
+         * @brief number of write accesses (get(), ->, *, push) including
+         * new values received from other runtimes or processes
+         */
+        std::uint64_t writes;
+
+        /**
+         * @brief serialized size of the value in bytes, 0 if the value is
+         * not Serializable or was not written. Taken from
+         * Serializable::lmsSerializedSize() if implemented, otherwise
+         * measured by serializing the value every SIZE_INTERVAL cycles.
+         */
+        std::uint64_t bytes;
+
+        /**
+         * @brief time reading modules waited for the channel's writers,
+         * summed over all readers
+         */
+        std::int64_t blockedMicros;
+    };
+
+    /**
+     * @brief Cycles between two measurements of the serialized size of
+     * values without Serializable::lmsSerializedSize().
+     */
+    static constexpr int SIZE_INTERVAL = 100;
+
+    /**
+     * @param label profiler label id of "runtime.channel"
+     */
+    explicit ChannelStats(std::uint32_t label) : m_reads(0), m_writes(0),
+        m_blockedMicros(0), m_cycles(0), m_label(label), m_size(0), m_sizeCycle(-1) {}
+
+    std::uint32_t label() const {
+        return m_label;
+    }
+
+    void countRead() {
+        m_reads.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void countWrite() {
+        m_writes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void addBlocked(std::int64_t micros) {
+        m_blockedMicros.fetch_add(micros, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Check if the serialized size measured last is too old.
+     */
+    bool sizeOutdated(int cycle) const {
+        return m_sizeCycle < 0 || cycle - m_sizeCycle >= SIZE_INTERVAL;
+    }
+
+    /**
+     * @brief Remember the serialized size measured in the given cycle.
+     */
+    void size(int cycle, std::uint64_t bytes) {
+        m_size = bytes;
+        m_sizeCycle = cycle;
+    }
+
+    /**
+     * @brief Serialized size measured last.
+     */
+    std::uint64_t size() const {
+        return m_size;
+    }
+
+    /**
+     * @brief Take the counters of the current cycle and add them to the
+     * totals.
+     *
+     * @param bytes serialized size of the value in this cycle
+     * @return values of the cycle that just ended
+     */
+    Values collect(std::uint64_t bytes) {
+        Values cycle;
+        cycle.reads = m_reads.exchange(0, std::memory_order_relaxed);
+        cycle.writes = m_writes.exchange(0, std::memory_order_relaxed);
+        cycle.blockedMicros = m_blockedMicros.exchange(0, std::memory_order_relaxed);
+        cycle.bytes = bytes;
+
+        m_total.reads += cycle.reads;
+        m_total.writes += cycle.writes;
+        m_total.bytes += cycle.bytes;
+        m_total.blockedMicros += cycle.blockedMicros;
+        m_cycles++;
+
+        return cycle;
+    }
+
+    /**
+     * @brief Sum of all collected cycles.
+     */
+    Values const& total() const {
+        return m_total;
+    }
+
+    /**
+     * @brief Number of collected cycles.
+     */
+    std::uint64_t cycles() const {
+        return m_cycles;
+    }
+private:
+    std::atomic<std::uint64_t> m_reads;
+    std::atomic<std::uint64_t> m_writes;
+    std::atomic<std::int64_t> m_blockedMicros;
+
+    Values m_total;
+    std::uint64_t m_cycles;
+
+    std::uint32_t m_label;
+    std::uint64_t m_size;
+    int m_sizeCycle;
+};
+
+}  // namespace internal
+}  // namespace lms
+
+#endif // LMS_INTERNAL_CHANNEL_STATS_H
@@ -84,6 +84,18 @@ public:
      * of the main loop's body.
      */
     void beforeLoopIteration();
+
+    /**
+     * @brief Duration of the last loop body, measured in
+     * beforeLoopIteration(). Zero before the second iteration.
+     */
+    Time lastWorkTime() const;
+
+    /**
+     * @brief How much the last loop body exceeded the cycle time, zero if
+     * it was fast enough or no cycle time is set.
+     */
+    Time lastOverflow() const;
 private:
     logging::Logger logger;
 
@@ -97,6 +109,7 @@ private:
     bool firstIteration;
     Time beforeWorkTimestamp;
     Time overflowTime;
+    Time m_lastWorkTime;
 };
 
 }  // namespace internal
@@ -3,6 +3,7 @@
 #include <cstring>
 #include <vector>
 #include <memory>
+#include <unordered_set>
 #include <algorithm>
 #include "lms/logger.h"
 #include "lms/serializable.h"
@@ -10,12 +11,18 @@
 #include "lms/extra/type.h"
 #include "lms/type_result.h"
 #include "lms/any.h"
+#include "lms/time.h"
+#include "shared_memory_segment.h"
+#include "channel_stats.h"
+#include "provenance.h"
 
 namespace lms {
 namespace internal {
 
 class Runtime; //circle dependency
 class ModuleWrapper;
+class ChannelSnapshot;
+class ChannelArena;
 
 // BACKEND
 
@@ -34,6 +41,19 @@ struct ObjectBase {
     virtual bool isVoid() const =0;
     virtual bool supportsInheritance() const = 0;
 
+    /**
+     * @brief Create a new default constructed object of the same type.
+     * @return new object, must be deleted by the caller
+     */
+    virtual ObjectBase* create() const = 0;
+
+    /**
+     * @brief Copy the value of another object into this one.
+     * @param other object of the same type
+     * @return false if the types differ or the value is not copyable
+     */
+    virtual bool copyFrom(const ObjectBase &other) = 0;
+
     /**
      *
      * return returns SUBTYPE if the current object is a subtype of the given one (hashcode)
@@ -114,6 +134,15 @@ struct FakeObject: public ObjectBase{
         return std::is_same<T, Any>::value;
     }
 
+    ObjectBase* create() const override {
+        return new FakeObject<T>();
+    }
+
+    bool copyFrom(const ObjectBase &other) override {
+        (void)other;
+        return false;
+    }
+
     virtual ~FakeObject(){}
 };
 
@@ -151,79 +180,205 @@ struct Object : public FakeObject<T> {
     Serializable* getSerializable() override{
         return InheritanceCallerGet<T,Serializable,std::is_base_of<Serializable,T>::value>::call(this);
     }
+
+    template <typename A, bool copyable>
+    struct CopyCaller;
+
+    template <typename A>
+    struct CopyCaller<A, false> {
+        static bool call(Object<A> *obj, const Object<A> &other) {
+            (void)obj;
+            (void)other;
+            return false;
+        }
+    };
+
+    template <typename A>
+    struct CopyCaller<A, true> {
+        static bool call(Object<A> *obj, const Object<A> &other) {
+            obj->value = other.value;
+            return true;
+        }
+    };
+
+    ObjectBase* create() const override {
+        return new Object<T>();
+    }
+
+    bool copyFrom(const ObjectBase &other) override {
+        if(other.hashCode() != this->hashCode()) {
+            return false;
+        }
+        return CopyCaller<T, std::is_copy_assignable<T>::value>::call(
+            this, static_cast<const Object<T>&>(other));
+    }
+};
+
+/**
+ * @brief Deletes channel values that were placed in a ChannelArena or were
+ * allocated with new if no arena is set.
+ */
+struct ObjectDeleter {
+    ObjectDeleter() : size(0) {}
+    ObjectDeleter(std::shared_ptr<ChannelArena> arena, std::size_t size)
+        : arena(arena), size(size) {}
+
+    std::shared_ptr<ChannelArena> arena;
+    std::size_t size;
+
+    void operator()(ObjectBase *obj) const;
 };
 
+typedef std::unique_ptr<ObjectBase, ObjectDeleter> ObjectPtr;
+
 /*
 template<typename T>
 class ReadDataChannel;
 */
 class DataChannelInternal {
 public:
+    DataChannelInternal() : nameHash(0), maintainer(nullptr), dataHost(nullptr),
+        sharedSequence(0), cycleCounter(nullptr), m_cycle(-1) {}
 
-
-    std::unique_ptr<ObjectBase> main;
-    std::vector<DataChannelInternal> m_preBuffer;
-    std::vector<DataChannelInternal> m_buffer;
+    ObjectPtr main;
 
     virtual ~DataChannelInternal() {}
 
     std::string name;
 
+    /**
+     * @brief nameHash extra::stableHash() of the name
+     */
+    std::uint64_t nameHash;
+
     /**
      * @brief maintainer Runtime that holds the dataChannel
      */
     Runtime *maintainer;
     /**
-     * @brief runtimes which need the dataChannel
+     * @brief dataHost runtime that provides the data, nullptr if the data
+     * is written in the maintainer runtime
      */
-    std::vector<Runtime*> runtimes;
+    Runtime *dataHost;
     /**
-     * @brief dataHost runtime that provides the data
+     * @brief snapshot latest data published by the dataHost, only set
+     * if the channel is imported from another runtime
      */
-    const Runtime *dataHost;
-    int m_cycle; //TODO not sure where/how to set it // -> (not const) sets current cycle-count + returns const ->
+    std::shared_ptr<ChannelSnapshot> snapshot;
     /**
-     * @brief readers reading modules
+     * @brief sharedMemory segment that mirrors the channel value to other
+     * processes, only set if the channel is configured to do so
      */
-    std::vector<std::shared_ptr<ModuleWrapper>> readers;
+    std::unique_ptr<SharedMemorySegment> sharedMemory;
     /**
-     * @brief writers writing modules
+     * @brief sharedSequence sequence number of the last value that was read
+     * from the shared memory segment
      */
-    std::vector<std::shared_ptr<ModuleWrapper>> writers;
+    std::uint64_t sharedSequence;
     /**
-     * @brief addRuntime adds Runtime that wants the data
-     * @param runtime
+     * @brief cycleCounter current cycle of the maintainer, used to stamp
+     * write accesses
      */
-    void addRuntime(Runtime *runtime){
-        runtimes.push_back(runtime);
-    }
+    const int *cycleCounter;
     /**
-     * @brief clearRuntimes clears the list of depending runtimes
+     * @brief m_cycle cycle of the last write access, -1 if never written
      */
-    void clearRuntimes(){
-        runtimes.clear();
-    }
+    int m_cycle;
+    /**
+     * @brief writeTime time of the first write access in m_cycle
+     */
+    Time writeTime;
+    /**
+     * @brief provenance origin of the current value, see Provenance
+     */
+    Provenance provenance;
+    /**
+     * @brief stats access counters, only set if channel statistics are
+     * enabled
+     */
+    std::unique_ptr<ChannelStats> stats;
+    /**
+     * @brief readers reading modules, use addReader() to modify
+     */
+    std::vector<std::shared_ptr<ModuleWrapper>> readers;
+    /**
+     * @brief writers writing modules, use addWriter() to modify
+     */
+    std::vector<std::shared_ptr<ModuleWrapper>> writers;
 
-    bool isReader(std::shared_ptr<ModuleWrapper> module) const{
-        return std::find(readers.begin(),readers.end(),module) != readers.end();
+    bool isReader(std::shared_ptr<ModuleWrapper> const& module) const{
+        return readerSet.count(module.get()) != 0;
     }
 
-    bool isWriter(std::shared_ptr<ModuleWrapper> module) const{
-        return std::find(writers.begin(),writers.end(),module) != writers.end();
+    bool isWriter(std::shared_ptr<ModuleWrapper> const& module) const{
+        return writerSet.count(module.get()) != 0;
     }
 
-    bool isReaderOrWriter(std::shared_ptr<ModuleWrapper> module) const{
+    bool isReaderOrWriter(std::shared_ptr<ModuleWrapper> const& module) const{
         return isReader(module) || isWriter(module);
     }
 
+    void addReader(std::shared_ptr<ModuleWrapper> const& module) {
+        if(readerSet.insert(module.get()).second) {
+            readers.push_back(module);
+        }
+    }
+
+    void addWriter(std::shared_ptr<ModuleWrapper> const& module) {
+        if(writerSet.insert(module.get()).second) {
+            writers.push_back(module);
+        }
+    }
+
+    /**
+     * @brief Remove the module from the readers and writers.
+     * @return true if the channel has no readers and writers anymore
+     */
+    bool removeModule(std::shared_ptr<ModuleWrapper> const& module) {
+        if(readerSet.erase(module.get()) != 0) {
+            readers.erase(std::remove(readers.begin(), readers.end(), module), readers.end());
+        }
+        if(writerSet.erase(module.get()) != 0) {
+            writers.erase(std::remove(writers.begin(), writers.end(), module), writers.end());
+        }
+        return readers.empty() && writers.empty();
+    }
+
     /**
      * @brief getCycle
-     * @return cycle in which the object was created
+     * @return cycle in which the object was written the last time
      */
     int getCycle() const{
         return m_cycle;
     }
 
+    /**
+     * @brief Count a read access if statistics are enabled.
+     */
+    void countRead() {
+        if(stats) {
+            stats->countRead();
+        }
+    }
+
+    /**
+     * @brief Remember the current cycle and time as the last write access.
+     * Only the first call in each cycle takes the time and makes the
+     * channel the source of its value, every call is counted if statistics
+     * are enabled.
+     */
+    void stampWrite() {
+        if(stats) {
+            stats->countWrite();
+        }
+        if(cycleCounter != nullptr && m_cycle != *cycleCounter) {
+            m_cycle = *cycleCounter;
+            writeTime = Time::now();
+            provenance.origin = writeTime;
+            provenance.source = nameHash;
+        }
+    }
+
     bool hasReader() const{
         return readers.size() > 0;
     }
@@ -235,36 +390,16 @@ public:
         return writers.size() > 0;
     }
 
-    /**
-     * @brief sharesData
-     * @return true if the data is accessed by another runtime
-     */
-    bool sharesData() const{
-        return runtimes.size() > 0;
-    }
-
     /**
      * @brief buffered
      * @return true if it receives data from another runtime (hasWriters returns false!)
      */
     bool buffered() const {
-        return dataHost != nullptr;//TODO not sure if this works
-    }
-
-    //called after each cycle of the runtime for each dataChannel
-    void bufferCycle(){
-        if(buffered()){
-        //clears the buffer
-        m_buffer.clear();
-        }else if(sharesData()){
-        //add data to other runtime
-        for(Runtime *runtime : runtimes){
-            (void)runtime;
-            //TODO
-            //runtime.addData(this);
-            }
-        }
+        return dataHost != nullptr;
     }
+private:
+    std::unordered_set<const ModuleWrapper*> readerSet;
+    std::unordered_set<const ModuleWrapper*> writerSet;
 };
 
 }  // namespace internal
@@ -8,13 +8,23 @@
 #include <memory>
 #include <typeinfo>
 #include <type_traits>
+#include <mutex>
+#include <new>
+#include <functional>
 
 #include <lms/logger.h>
 #include <lms/extra/type.h>
+#include <lms/extra/string.h>
+#include <lms/extra/latency_histogram.h>
 #include <lms/serializable.h>
 #include "module_wrapper.h"
 #include "dot_exporter.h"
+#include "channel_snapshot.h"
+#include "channel_arena.h"
 #include "lms/data_channel.h"
+#include "lms/queue_channel.h"
+#include "lms/buffer_pool.h"
+#include "lms/shared_memory.h"
 #include "lms/deprecated.h"
 
 namespace lms {
@@ -72,17 +82,22 @@ public:
             //logger.debug("accessChannel")<<"creating new dataChannel"<<name<<" to "<< typeid(T).name();
             channel = std::make_shared<DataChannelInternal>();
             channel->maintainer = &m_runtime;
+            channel->cycleCounter = &m_cycle;
+            channel->nameHash = extra::stableHash(name);
+            if (m_channelStats) {
+                channel->stats.reset(newChannelStats(name));
+            }
 
             //check if T is abstract
             if (std::is_abstract<T>::value) {
-                channel->main.reset(new FakeObject<T>());
+                channel->main = ObjectPtr(new FakeObject<T>());
             } else {
-                channel->main.reset(new Object<T>());
-
+                channel->main = createObject<T>();
+                attachSharedMemory(name, channel, sizeof(T), SharedMemoryCompatible<T>::value);
             }
         } else {
             if (!channel->main) {
-                channel->main.reset(new Object<T>());
+                channel->main = createObject<T>();
                 logger.error("accessChannel") << "INVALID STATE, channel != null && channel->main == null";
             } else {
                 TypeResult typeRes = channel->main->checkType<T>();
@@ -95,7 +110,8 @@ public:
                     logger.info("accessChannel") << "upgrading channel " << name << " to " << typeid(T).name();
                     //delete old object
                     //create new one
-                    channel->main.reset(new Object<T>());
+                    channel->main = createObject<T>();
+                    attachSharedMemory(name, channel, sizeof(T), SharedMemoryCompatible<T>::value);
                 }
             }
         }
@@ -105,6 +121,25 @@ public:
         return channel;
     }
 
+    /**
+     * @brief Create a default constructed channel value in the arena.
+     *
+     * Falls back to the heap if the arena cannot provide the memory.
+     */
+    template<typename T>
+    ObjectPtr createObject() {
+        void *mem = m_arena->allocate(sizeof(Object<T>), alignof(Object<T>));
+        if (mem == nullptr) {
+            return ObjectPtr(new Object<T>());
+        }
+        return ObjectPtr(new (mem) Object<T>(), ObjectDeleter(m_arena, sizeof(Object<T>)));
+    }
+
+    /**
+     * @brief Memory for all channel values of this runtime.
+     */
+    ChannelArena& arena();
+
     /**
      * @brief Return the data channel with the given name with read permissions
      * or create one if needed.
@@ -116,10 +151,7 @@ public:
     template<typename T>
     ReadDataChannel<T> readChannel(std::shared_ptr<ModuleWrapper> module, const std::string &reqName) {
         std::shared_ptr<DataChannelInternal> channel = accessChannel<T>(module, reqName);
-        if (!channel->isReaderOrWriter(module)) {
-            channel->readers.push_back(module);
-            invalidateExecutionManager();
-        }
+        registerReader(module, channel);
         return channel;
     }
 
@@ -134,13 +166,145 @@ public:
     template<typename T>
     WriteDataChannel<T> writeChannel(std::shared_ptr<ModuleWrapper> module, const std::string &reqName) {
         std::shared_ptr<DataChannelInternal> channel = accessChannel<T>(module, reqName);
-        if (!channel->isReaderOrWriter(module)) {
-            channel->writers.push_back(module);
-            invalidateExecutionManager();
-        }
+        registerWriter(module, channel);
+        return channel;
+    }
+
+    /**
+     * @brief Return the queue channel with the given name with read
+     * permissions or create one if needed.
+     *
+     * @param module the requesting module
+     * @param name queue channel name
+     * @return queue channel (only popping)
+     */
+    template<typename T>
+    ReadQueueChannel<T> readQueue(std::shared_ptr<ModuleWrapper> module, const std::string &reqName) {
+        std::shared_ptr<DataChannelInternal> channel = accessChannel<Queue<T>>(module, reqName);
+        registerReader(module, channel);
+        initQueue<T>(channel);
+        return channel;
+    }
+
+    /**
+     * @brief Return the queue channel with the given name with write
+     * permissions or create one if needed.
+     *
+     * @param module the requesting module
+     * @param name queue channel name
+     * @return queue channel (only pushing)
+     */
+    template<typename T>
+    WriteQueueChannel<T> writeQueue(std::shared_ptr<ModuleWrapper> module, const std::string &reqName) {
+        std::shared_ptr<DataChannelInternal> channel = accessChannel<Queue<T>>(module, reqName);
+        registerWriter(module, channel);
+        initQueue<T>(channel);
         return channel;
     }
 
+    /**
+     * @brief Return the buffer pool of the channel with the given name or
+     * create one if needed.
+     *
+     * The number of buffers is taken from the channel's config.
+     *
+     * @param module the requesting module
+     * @param reqName data channel name
+     * @param init called once for each new buffer
+     * @return buffer pool or nullptr if the channel's pool has another type
+     */
+    template<typename T>
+    std::shared_ptr<BufferPool<T>> bufferPool(std::shared_ptr<ModuleWrapper> module,
+                                              const std::string &reqName,
+                                              std::function<void(T&)> init) {
+        std::string name = module->getChannelMapping(reqName);
+        std::shared_ptr<BufferPoolBase> &pool = m_bufferPools[name];
+
+        if (!pool) {
+            pool = std::make_shared<BufferPool<T>>(channelConfig(name).poolSize, init);
+        } else if (pool->hashCode() != typeid(T).hash_code()) {
+            logger.error("bufferPool") << "Buffer pool of channel " << name
+                << " was created with another type than " << extra::typeName<T>();
+            return nullptr;
+        }
+
+        return std::static_pointer_cast<BufferPool<T>>(pool);
+    }
+
+    /**
+     * @brief Settings of a data channel given in the <channel> config tag.
+     */
+    struct ChannelConfig {
+        ChannelConfig() : queueCapacity(DEFAULT_QUEUE_CAPACITY),
+            poolSize(DEFAULT_POOL_SIZE) {}
+
+        /**
+         * @brief name of the POSIX shared memory segment the channel is
+         * mirrored to, empty if the channel is process-local
+         */
+        std::string sharedMemory;
+
+        /**
+         * @brief maximum number of items if the channel is a queue channel
+         */
+        std::size_t queueCapacity;
+
+        /**
+         * @brief number of buffers in the channel's buffer pool
+         */
+        std::size_t poolSize;
+    };
+
+    static constexpr std::size_t DEFAULT_QUEUE_CAPACITY = 64;
+    static constexpr std::size_t DEFAULT_POOL_SIZE = 4;
+
+    /**
+     * @brief Return the settings of the channel with the given name.
+     *
+     * Settings must be made before the channel is accessed for the first
+     * time.
+     *
+     * @param name data channel name
+     */
+    ChannelConfig& channelConfig(const std::string &name);
+
+    /**
+     * @brief Count the read and write accesses of all channels and report
+     * them to the profiler at the end of each cycle.
+     */
+    void enableChannelStats(bool flag);
+
+    bool channelStats() const;
+
+    /**
+     * @brief Measure the latency from a source channel to a sink channel.
+     *
+     * Whenever a module of this runtime writes the sink channel and the
+     * oldest input that contributed to it came from the source channel,
+     * the time between the source's write access and the end of the module
+     * is recorded. The source may be in another runtime or process.
+     *
+     * @param from source channel name
+     * @param to sink channel name
+     */
+    void traceLatency(const std::string &from, const std::string &to);
+
+    /**
+     * @brief Copy the latency histogram of a traced path.
+     *
+     * @param from source channel name
+     * @param to sink channel name
+     * @param histogram receives the recorded latencies
+     * @return false if the path is not traced
+     */
+    bool latency(const std::string &from, const std::string &to,
+                 extra::LatencyHistogram &histogram);
+
+    /**
+     * @brief Log the latency histograms of all traced paths.
+     */
+    void printLatencies();
+
     void writeDAG(DotExporter &dot, const std::string &prefix);
 
     /**
@@ -154,9 +318,149 @@ public:
      */
     void reset();
 
+    /**
+     * @brief Receive the latest snapshots of all channels that are imported
+     * from other runtimes and the latest values of all shared memory
+     * channels that are not written in this runtime.
+     *
+     * Must be called by the execution manager before the modules are
+     * cycled and after the cycle counter was incremented.
+     */
+    void beforeCycle();
+
+    /**
+     * @brief Publish snapshots of all channels that are exported to other
+     * runtimes and write all shared memory channels that are written in
+     * this runtime.
+     *
+     * Must be called by the execution manager after the modules were cycled.
+     * This method never blocks: if another runtime is registering a new
+     * export at the same time, publishing is skipped for this cycle.
+     */
+    void afterCycle();
+
+    /**
+     * @brief Export a channel of this runtime to another runtime.
+     *
+     * This method is thread-safe and is called by the consuming runtime.
+     *
+     * @param name channel name
+     * @param consumer runtime that receives the snapshots
+     * @return snapshot that will be published at the end of each cycle
+     */
+    std::shared_ptr<ChannelSnapshot> exportChannel(const std::string &name, Runtime *consumer);
+
 private:
     Runtime &m_runtime;
 
+    /**
+     * @brief cycle counter of the execution manager, updated in
+     * beforeCycle() and used to stamp write accesses of all channels
+     */
+    int m_cycle;
+
+    bool m_channelStats;
+
+    struct Export {
+        std::string channel;
+        Runtime *consumer;
+        std::shared_ptr<ChannelSnapshot> snapshot;
+    };
+
+    /**
+     * @brief channels that are read from other runtimes
+     */
+    std::vector<std::shared_ptr<DataChannelInternal>> m_imports;
+
+    /**
+     * @brief channels that are published to other runtimes
+     */
+    std::vector<Export> m_exports;
+    std::mutex m_exportsMutex;
+
+    std::unordered_map<std::string, ChannelConfig> m_channelConfigs;
+
+    std::shared_ptr<ChannelArena> m_arena;
+
+    /**
+     * @brief buffer pools by channel name
+     */
+    std::unordered_map<std::string, std::shared_ptr<BufferPoolBase>> m_bufferPools;
+
+    struct LatencyPath {
+        std::string from;
+        std::string to;
+        std::uint64_t fromHash;
+        std::uint64_t toHash;
+        extra::LatencyHistogram histogram;
+    };
+
+    /**
+     * @brief source and sink pairs given in <latency> config tags
+     */
+    std::vector<LatencyPath> m_latencyPaths;
+    std::mutex m_latencyMutex;
+
+    /**
+     * @brief channels that are mirrored to shared memory segments
+     */
+    std::vector<std::shared_ptr<DataChannelInternal>> m_sharedChannels;
+
+    /**
+     * @brief channels that are read or written by each module
+     */
+    std::unordered_map<ModuleWrapper*,
+        std::vector<std::shared_ptr<DataChannelInternal>>> m_moduleChannels;
+
+    /**
+     * @brief Grant read access to the module if not done yet and connect
+     * the channel to its providing runtime.
+     */
+    void registerReader(std::shared_ptr<ModuleWrapper> const& module,
+                        std::shared_ptr<DataChannelInternal> const& channel);
+
+    /**
+     * @brief Grant write access to the module if not done yet.
+     */
+    void registerWriter(std::shared_ptr<ModuleWrapper> const& module,
+                        std::shared_ptr<DataChannelInternal> const& channel);
+
+    /**
+     * @brief Create the queue of a queue channel on first access and choose
+     * the single producer fast path if there is only one writer.
+     */
+    template<typename T>
+    void initQueue(std::shared_ptr<DataChannelInternal> const& channel) {
+        Queue<T> *queue = static_cast<Queue<T>*>(channel->main->get());
+        if (queue->get() == nullptr) {
+            queue->reset(channelConfig(channel->name).queueCapacity);
+        }
+        queue->get()->singleProducer(channel->writers.size() <= 1);
+    }
+
+    /**
+     * @brief Open the shared memory segment of the channel if the channel
+     * is configured to use one.
+     *
+     * @param name data channel name
+     * @param channel channel with a newly created value
+     * @param size size of the channel's value in bytes
+     * @param compatible true if the value may be copied byte-wise
+     */
+    void attachSharedMemory(const std::string &name,
+                            std::shared_ptr<DataChannelInternal> channel,
+                            std::size_t size, bool compatible);
+
+    /**
+     * @brief Connect the channel to the runtime that provides it, if the
+     * module's config says so.
+     *
+     * @param module the requesting module
+     * @param channel channel that was accessed by the module
+     */
+    void importChannel(std::shared_ptr<ModuleWrapper> module,
+                       std::shared_ptr<DataChannelInternal> channel);
+
     /**
      * @brief Return the internal data channel mapping. THIS IS NOT
      * INTENDED TO BE USED IN MODULES.
@@ -168,12 +472,35 @@ private:
     /**
      * @brief Release all channels
      *
-     * This should be called in lms::Module::deinitialize.
+     * This should be called in lms::Module::deinitialize. Takes time
+     * proportional to the number of channels of the module.
      *
      * @param module the module to look for
      */
     void releaseChannelsOf(std::shared_ptr<ModuleWrapper> mod);
 
+    /**
+     * @brief Report the statistics of the cycle that just ended to the
+     * profiler.
+     */
+    void collectChannelStats();
+
+    /**
+     * @brief Create the statistics of a channel and register its profiler
+     * label.
+     */
+    ChannelStats* newChannelStats(const std::string &name);
+
+    /**
+     * @brief Pass the provenance of the oldest fresh input of the module on
+     * to all channels it wrote in this cycle and record the latency of
+     * traced sink channels.
+     *
+     * Must be called by the execution manager after the module's cycle.
+     * Thread-safe for distinct modules.
+     */
+    void traceModule(ModuleWrapper &module);
+
     /**
      * @brief Invoke invalidate() on the execution manager instance.
      *
@@ -6,6 +6,8 @@
 #include <memory>
 #include <thread>
 #include <queue>
+#include <functional>
+#include <atomic>
 
 #include "lms/logger.h"
 
@@ -18,9 +20,20 @@ public:
     ~DebugServer();
 
     enum class MessageType : std::uint8_t {
-        LOGGING = 1, PROFILING = 2
+        LOGGING = 1, PROFILING = 2, CHANNEL_STATS = 3, HISTOGRAM = 4,
+        /** sent by clients: 8 bit Profiler::Level, optionally followed by
+         * the 32 bit sample interval */
+        PROFILING_LEVEL = 5,
+        /** batched profiling records, see TelemetryEncoder */
+        TELEMETRY = 6
     };
 
+    /**
+     * @brief Called from the server thread for every message a client sent.
+     */
+    typedef std::function<void(MessageType type, const std::uint8_t *data,
+                               std::size_t size)> MessageHandler;
+
     class Datagram {
     public:
         Datagram(MessageType type, uint32_t messageLen);
@@ -42,9 +55,21 @@ public:
 
     bool useDualstack(uint16_t port);
 
+    /**
+     * @brief Set the handler for messages sent by clients. Must be called
+     * before startThread().
+     */
+    void onMessage(MessageHandler handler);
+
     void startThread();
 
     void broadcast(Datagram const& datagram);
+
+    /**
+     * @brief Number of clients that connected so far. Changes whenever a
+     * client connects that has not seen previous broadcasts.
+     */
+    std::uint64_t connections() const;
 private:
     void enableReuseAddr(int sock);
 
@@ -77,11 +102,14 @@ private:
     bool m_shutdown;
 
     std::mutex m_outMutex;
+    MessageHandler m_handler;
+    std::atomic<std::uint64_t> m_connections;
 
     void processWrites();
     void processReads();
     void processServer(int sockfd);
     void processClient(Client & client);
+    void processMessages(Client & client);
     void processOutqueue(Client &client);
 };
 
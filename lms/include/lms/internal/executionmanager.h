@@ -65,6 +65,9 @@ public:
     /**
      * @brief Enable module with the given name, add it to the cycle-queue.
      *
+     * The module is loaded from its library unless its wrapper already
+     * holds an instance, e.g. one linked into the executable.
+     *
      * @param name name of the module that should be enabled
      * @param minLogLevel minimum logging level
      */
@@ -124,6 +127,30 @@ public:
      */
     bool enabledMultithreading() const;
 
+    /**
+     * @brief Measure wall time and thread CPU time of each module cycle.
+     */
+    void enableCpuTime(bool flag);
+
+    /**
+     * @brief Log the ratio of CPU time to wall time per module, per worker
+     * thread and for the whole runtime. A low ratio means the module was
+     * blocked or preempted rather than computing.
+     */
+    void printCpuTime();
+
+    /**
+     * @brief Count heap allocations of each module cycle and report them
+     * as profiler counters.
+     * @return false if allocations cannot be counted on this platform
+     */
+    bool enableAllocations(bool flag);
+
+    /**
+     * @brief Log the allocations per module.
+     */
+    void printAllocations();
+
     WatchDog & dog();
 
     DataManager& getDataManager();
@@ -211,6 +238,56 @@ private:
     void sort();
     void sortModules();
     void addModuleDependency(std::shared_ptr<ModuleWrapper> dependent, std::shared_ptr<ModuleWrapper> independent);
+
+    /**
+     * @brief Check if the module wants to be skipped and none of its
+     * read channels was written since its last cycle.
+     */
+    bool unchangedInputs(ModuleWrapper const& mod) const;
+
+    /**
+     * @brief Time at which the current cycle was handed to the thread pool.
+     */
+    Time m_cycleStart;
+
+    /**
+     * @brief Add the time the module waited for the writers of its read
+     * channels to the channel statistics. Must be called with the mutex
+     * locked.
+     *
+     * @param mod module that is about to be executed
+     * @param start time at which the module was picked by a thread
+     */
+    void recordBlocked(ModuleWrapper const& mod, Time start);
+
+    struct CpuTime {
+        Time wall;
+        Time cpu;
+
+        /* each worker thread writes its own slot */
+        char padding[64 - 2 * sizeof(Time)];
+    };
+
+    bool m_cpuTime;
+
+    /**
+     * @brief Wall and CPU time per worker thread, indexed by thread number.
+     */
+    std::vector<CpuTime> m_threadCpuTime;
+
+    /**
+     * @brief Add the time since the given start values to the module and
+     * the thread.
+     */
+    void accountCpuTime(ModuleWrapper &mod, int threadNum, Time wallStart, Time cpuStart);
+
+    bool m_allocations;
+
+    /**
+     * @brief Add the allocations of a module cycle to the module and
+     * report them to the profiler.
+     */
+    void accountAllocations(ModuleWrapper &mod, AllocationTracker::Counters const& counters);
 };
 
 }  // namespace internal
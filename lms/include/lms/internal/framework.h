@@ -12,6 +12,7 @@
 #include "lms/deprecated.h"
 #include "runtime.h"
 #include "debug_server.h"
+#include "histogram_profiler.h"
 
 namespace lms {
 namespace internal {
@@ -67,6 +68,12 @@ public:
 
     Profiler& profiler();
 
+    /**
+     * @brief Latency histograms of all modules, nullptr if not enabled
+     * with --histograms.
+     */
+    HistogramProfiler* histograms();
+
     Loader<Module>& moduleLoader();
 
     std::shared_ptr<ServiceWrapper> getServiceWrapper(std::string const& name);
@@ -88,6 +95,8 @@ private:
 
     ArgumentHandler argumentHandler;
     Profiler m_profiler;
+    HistogramProfiler *m_histograms;
+    DebugServerProfiler *m_debugServerProfiler;
     Loader<Module> m_moduleLoader;
     Loader<Service> m_serviceLoader;
 
@@ -0,0 +1,143 @@
+#ifndef LMS_INTERNAL_HISTOGRAM_PROFILER_H
+#define LMS_INTERNAL_HISTOGRAM_PROFILER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+
+#include "profiler.h"
+#include "perf_counters.h"
+#include "debug_server.h"
+#include "thread_slot.h"
+#include "lms/extra/latency_histogram.h"
+#include "lms/logger.h"
+
+namespace lms {
+namespace internal {
+
+/**
+ * @brief Profiling listener that aggregates the durations between begin
+ * and end markers into latency histograms, one per label.
+ *
+ * Besides the total since startup, each label keeps a sliding window made
+ * of several shorter windows: the oldest one is dropped whenever a new one
+ * starts. Whenever a window ends, a summary of every label is broadcast via
+ * the debug server (if given).
+ *
+ * If enabled, performance counters (cycles, instructions, cache misses,
+ * context switches) of the executing thread are read at each begin and end
+ * marker and their deltas are summed up per label as well.
+ *
+ * Labels are "runtime" for whole runtime cycles and "runtime.module" for
+ * modules.
+ */
+class HistogramProfiler : public Profiler::ProfilingListener {
+public:
+    /**
+     * @param window duration of a single window
+     * @param windows number of windows in the sliding window
+     */
+    explicit HistogramProfiler(Time window = Time::fromMillis(1000),
+                               std::size_t windows = 10);
+
+    /**
+     * @brief Broadcast the sliding window summaries whenever a window ends.
+     */
+    void debugServer(DebugServer *server);
+
+    /**
+     * @brief Read performance counters at every marker. Must be called
+     * before the listener is appended to the profiler.
+     */
+    void perfCounters(bool enable);
+
+    void onLabel(Profiler::LabelId id, std::string const& label) override;
+    void onMarker(Profiler::Type type, lms::Time now, Profiler::LabelId id,
+                  std::string const& label) override;
+
+    /**
+     * @brief Histogram of the given label over the sliding window.
+     * @return false if the label is not known
+     */
+    bool recent(std::string const& label, extra::LatencyHistogram &hist) const;
+
+    /**
+     * @brief Histogram of the given label since startup.
+     * @return false if the label is not known
+     */
+    bool total(std::string const& label, extra::LatencyHistogram &hist) const;
+
+    /**
+     * @brief Performance counter deltas of the given label summed up since
+     * startup.
+     * @param values sums of all samples
+     * @param samples number of begin/end pairs that were counted
+     * @return false if the label is not known
+     */
+    bool counters(std::string const& label, PerfCounters::Values &values,
+                  std::uint64_t &samples) const;
+
+    /**
+     * @brief Log the totals of all labels that have samples.
+     */
+    void print(logging::Logger &logger) const;
+private:
+    struct Entry {
+        std::string label;
+        std::vector<extra::LatencyHistogram> windows;
+        extra::LatencyHistogram total;
+
+        PerfCounters::Values counters;
+        std::uint64_t counted;
+
+        /* bit i is set if counter i was opened in any counting thread */
+        unsigned available;
+    };
+
+    /* begin times of the calling thread per label, -1 if not begun */
+    struct BeginTimes {
+        std::vector<Time::TimeType> micros;
+
+        /* only used if performance counters are enabled */
+        std::unique_ptr<PerfCounters> perf;
+        std::vector<PerfCounters::Values> counters;
+    };
+
+    /**
+     * @brief Start new windows until now is inside the current one.
+     * Needs m_mutex.
+     * @param summaries if not null, receives the summaries of the sliding
+     * window before it moves on
+     */
+    void advance(Time now, std::vector<DebugServer::Datagram> *summaries);
+
+    void merge(Entry const& entry, extra::LatencyHistogram &hist) const;
+
+    /**
+     * @brief Build one datagram per label with samples. Needs m_mutex.
+     */
+    void summarize(Time now, std::vector<DebugServer::Datagram> &summaries);
+
+    const Time m_window;
+
+    ThreadSlot<BeginTimes, HistogramProfiler> m_beginTimes;
+
+    DebugServer *m_server;
+    bool m_perfCounters;
+
+    /* everything below is protected by m_mutex */
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Entry>> m_entries;
+    std::unordered_map<std::string, Profiler::LabelId> m_ids;
+    std::size_t m_numWindows;
+    std::size_t m_current;
+    Time m_windowStart;
+};
+
+}  // namespace internal
+}  // namespace lms
+
+#endif // LMS_INTERNAL_HISTOGRAM_PROFILER_H
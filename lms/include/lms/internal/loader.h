@@ -7,6 +7,7 @@
 #include <list>
 #include <string>
 #include <map>
+#include <functional>
 
 #include "pugixml.hpp"
 #include <lms/logger.h>
@@ -40,6 +41,7 @@ class Loader {
 private:
     logging::Logger logger;
     std::map<std::string, std::string> m_pathMapping;
+    std::map<std::string, std::function<T*()>> m_factories;
 public:
     Loader() : logger("lms.Loader") {
     }
@@ -72,6 +74,15 @@ public:
         }
     }
 
+    /**
+     * @brief Create instances for the given library name with a factory
+     * instead of loading a shared library, e.g. for modules that are
+     * linked into a test executable.
+     */
+    void addFactory(std::string const& libname, std::function<T*()> factory) {
+        m_factories[libname] = factory;
+    }
+
     template<typename _Target>
     union converter {
         void* src;
@@ -104,6 +115,12 @@ public:
      * @return the instance of the module
      */
     bool load(typename T::WrapperType *entry) {
+        auto factory = m_factories.find(entry->libname());
+        if(factory != m_factories.end()) {
+            entry->instance(factory->second());
+            return true;
+        }
+
         // for information on dlopen, dlsym, dlerror and dlclose
         // see here: http://linux.die.net/man/3/dlclose
 
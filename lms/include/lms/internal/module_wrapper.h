@@ -4,11 +4,14 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <vector>
+#include <cstdint>
 
 #include "lms/time.h"
 #include "lms/execution_type.h"
 #include "lms/config.h"
 #include "service_wrapper.h"
+#include "allocation_tracker.h"
 
 namespace lms {
 class Module;
@@ -16,6 +19,7 @@ class Module;
 namespace internal {
 
 class Runtime;
+class DataChannelInternal;
 
 /**
  * @brief The module_entry struct
@@ -46,7 +50,9 @@ class ModuleWrapper {
     std::unique_ptr<Module> m_moduleInstance;
 public:
     ModuleWrapper(Runtime *runtime) : m_runtime(runtime), m_enabled(false),
-        m_moduleInstance(nullptr) {}
+        m_moduleInstance(nullptr), skipIfUnchanged(false), lastCycle(-1),
+        profilingLabel(0), allocationCycles(0), allocationsLabel(0),
+        allocatedBytesLabel(0) {}
 
     std::string libname() const;
     void libname(std::string const& libname);
@@ -76,10 +82,27 @@ public:
      */
     std::map<std::string, int> channelPriorities;
 
+    /**
+     * @brief Runtimes that provide datachannels for this module. Maps
+     * (already mapped) datachannel names to runtime names.
+     *
+     * The module reads the latest snapshot of the datachannel that the
+     * other runtime published at the end of its cycle.
+     */
+    std::map<std::string, std::string> channelRuntimes;
+
     int getChannelPriority(const std::string &name) const;
 
     std::string getChannelMapping(const std::string &mapFrom) const;
 
+    /**
+     * @brief Return the runtime that provides the given datachannel.
+     * @param name mapped datachannel name
+     * @return runtime name or empty string if the channel is written in
+     * this module's runtime
+     */
+    std::string getChannelRuntime(const std::string &name) const;
+
     /**
      * @brief The module can only be executed on the specified thread.
      *
@@ -90,6 +113,62 @@ public:
 
     std::map<std::string, Config> configs;
 
+    /**
+     * @brief Do not call cycle() if none of the channels the module reads
+     * was written since the module's last cycle. Set by the module itself.
+     */
+    bool skipIfUnchanged;
+
+    /**
+     * @brief Cycle in which cycle() was called the last time, -1 if never.
+     */
+    int lastCycle;
+
+    /**
+     * @brief Time at which cycle() returned the last time, only tracked
+     * in multithreaded runtimes with channel statistics.
+     */
+    Time lastEnd;
+
+    /**
+     * @brief Channels that are read by the module. Maintained by the
+     * data manager.
+     */
+    std::vector<DataChannelInternal*> inputs;
+
+    /**
+     * @brief Channels that are written by the module. Maintained by the
+     * data manager.
+     */
+    std::vector<DataChannelInternal*> outputs;
+
+    /**
+     * @brief Profiler::LabelId of "runtime.module", registered by the
+     * execution manager in validate().
+     */
+    std::uint32_t profilingLabel;
+
+    /**
+     * @brief Wall time and thread CPU time spent in cycle(), summed up
+     * over all cycles. Only tracked if enabled (--cpu-time).
+     */
+    Time wallTime;
+    Time cpuTime;
+
+    /**
+     * @brief Heap allocations in cycle() summed up over all cycles and
+     * the number of counted cycles. Only tracked if enabled (--allocations).
+     */
+    AllocationTracker::Counters allocations;
+    std::uint64_t allocationCycles;
+
+    /**
+     * @brief Profiler::LabelId of the per cycle allocation counters
+     * "runtime.module.allocations" and "runtime.module.allocated bytes".
+     */
+    std::uint32_t allocationsLabel;
+    std::uint32_t allocatedBytesLabel;
+
     void update(ModuleWrapper && other);
 
     std::shared_ptr<ServiceWrapper> getServiceWrapper(std::string const& name);
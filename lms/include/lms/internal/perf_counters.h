@@ -0,0 +1,75 @@
+#ifndef LMS_INTERNAL_PERF_COUNTERS_H
+#define LMS_INTERNAL_PERF_COUNTERS_H
+
+#include <string>
+#include <cstdint>
+
+namespace lms {
+namespace internal {
+
+/**
+ * @brief Hardware and software performance counters of the calling thread,
+ * based on perf_event_open() (Linux only).
+ *
+ * Each counter is opened on its own, so counters the kernel does not allow
+ * (see /proc/sys/kernel/perf_event_paranoid) or the CPU does not support
+ * are just missing. Kernel time is excluded from hardware counters.
+ *
+ * An instance must only be used by the thread that opened it.
+ */
+class PerfCounters {
+public:
+    enum Counter {
+        CYCLES = 0, INSTRUCTIONS, CACHE_MISSES, CONTEXT_SWITCHES, COUNT
+    };
+
+    struct Values {
+        Values() : value{0, 0, 0, 0} {}
+
+        std::uint64_t value[COUNT];
+
+        Values& operator +=(Values const& other) {
+            for(int i = 0; i < COUNT; i++) {
+                value[i] += other.value[i];
+            }
+            return *this;
+        }
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(PerfCounters const&) = delete;
+    PerfCounters& operator=(PerfCounters const&) = delete;
+
+    /**
+     * @brief Open all counters for the calling thread.
+     * @return false if no counter could be opened, see error()
+     */
+    bool open();
+
+    /**
+     * @brief Check if the given counter was opened.
+     */
+    bool has(Counter counter) const;
+
+    /**
+     * @brief Read the current values, missing counters are 0.
+     */
+    void read(Values &values) const;
+
+    /**
+     * @brief Reason why the last open() failed.
+     */
+    std::string error() const;
+
+    static const char* name(Counter counter);
+private:
+    int m_fds[COUNT];
+    std::string m_error;
+};
+
+}  // namespace internal
+}  // namespace lms
+
+#endif // LMS_INTERNAL_PERF_COUNTERS_H
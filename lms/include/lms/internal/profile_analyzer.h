@@ -0,0 +1,198 @@
+#ifndef LMS_INTERNAL_PROFILE_ANALYZER_H
+#define LMS_INTERNAL_PROFILE_ANALYZER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+
+#include "profiler.h"
+#include "lms/extra/latency_histogram.h"
+#include "lms/time.h"
+
+namespace lms {
+namespace internal {
+
+/**
+ * @brief Offline analysis of files written by FileProfiler or
+ * BinaryProfiler, used by the lms-profile tool.
+ *
+ * Begin and end markers are paired per label and thread into intervals.
+ * Labels without a dot are runtime cycles ("runtime"), all others belong
+ * to the runtime before the dot ("runtime.module"). A module interval is
+ * part of the cycle of its runtime that contains its begin.
+ *
+ * The CSV format of FileProfiler has no thread column, all its markers are
+ * attributed to thread 0.
+ *
+ * Counters, e.g. the cycle time or the allocations of a module, are
+ * summarized per label.
+ */
+class ProfileAnalyzer {
+public:
+    struct Interval {
+        std::uint32_t label;
+        std::uint32_t thread;
+        lms::Time begin;
+        lms::Time end;
+
+        lms::Time duration() const {
+            return end - begin;
+        }
+    };
+
+    struct LabelStats {
+        std::string label;
+        extra::LatencyHistogram hist;
+        lms::Time total;
+
+        /* number of cycles the label was on the critical path */
+        std::uint64_t critical;
+        lms::Time criticalTime;
+    };
+
+    struct ThreadStats {
+        std::uint32_t thread;
+        /* time spent in modules */
+        lms::Time busy;
+        /* idle gaps between two modules of the same cycle */
+        std::uint64_t gaps;
+        lms::Time idle;
+        lms::Time maxGap;
+    };
+
+    struct CounterStats {
+        std::string label;
+        std::uint64_t count;
+        std::int64_t sum;
+        std::int64_t min;
+        std::int64_t max;
+    };
+
+    ProfileAnalyzer();
+
+    /**
+     * @brief Load a file, the format is detected automatically.
+     * @return false if the file cannot be read
+     */
+    bool load(std::string const& file);
+
+    /**
+     * @brief Load the CSV format of FileProfiler.
+     */
+    bool loadCsv(std::istream &stream);
+
+    /**
+     * @brief Add entries manually, e.g. from another reader. Markers of
+     * each thread must be added in chronological order.
+     */
+    void label(std::uint32_t id, std::string const& name);
+    void marker(Profiler::Type type, lms::Time time, std::uint32_t label,
+                std::uint32_t thread);
+    void counter(std::uint32_t label, std::int64_t value);
+
+    /**
+     * @brief Pair the markers and compute all statistics. Called by load(),
+     * must be called after adding markers manually.
+     */
+    void analyze();
+
+    /**
+     * @brief Name of a label id, or "#id" if unknown.
+     */
+    std::string labelName(std::uint32_t id) const;
+
+    /**
+     * @brief All complete intervals ordered by begin.
+     */
+    std::vector<Interval> const& intervals() const;
+
+    /**
+     * @brief Statistics of all labels (cycles and modules) by name.
+     */
+    std::map<std::string, LabelStats> const& labels() const;
+
+    /**
+     * @brief Statistics of all counters by name.
+     */
+    std::map<std::string, CounterStats> const& counters() const;
+
+    /**
+     * @brief Statistics of all threads that executed modules.
+     */
+    std::vector<ThreadStats> const& threads() const;
+
+    /**
+     * @brief Modules on the critical path of a cycle, outermost first.
+     *
+     * Starting at the end of the cycle, the path repeatedly takes the
+     * module of the same cycle that ended last before the current point
+     * and continues at its begin. The dependency graph is not part of the
+     * profile, so this is the chain of modules that finished just in time
+     * for their successors.
+     *
+     * @param cycle index into cycles()
+     */
+    std::vector<Interval> criticalPath(std::size_t cycle) const;
+
+    /**
+     * @brief All runtime cycle intervals ordered by begin.
+     */
+    std::vector<Interval> const& cycles() const;
+
+    /**
+     * @brief Time between the first and the last marker.
+     */
+    lms::Time span() const;
+
+    /**
+     * @brief Print all statistics in human readable form.
+     */
+    void print(std::ostream &os) const;
+
+    /**
+     * @brief Compare the mean and 99th percentile of all labels found in
+     * both profiles and print them.
+     * @param threshold relative increase (0.1 is 10%) that is flagged as
+     * a regression
+     * @return number of labels that regressed
+     */
+    static int compare(ProfileAnalyzer const& base, ProfileAnalyzer const& other,
+                       double threshold, std::ostream &os);
+private:
+    struct Marker {
+        Profiler::Type type;
+        lms::Time time;
+        std::uint32_t label;
+        std::uint32_t thread;
+    };
+
+    /**
+     * @brief Index into m_cycles of the cycle that contains the interval,
+     * -1 if none.
+     */
+    std::int64_t cycleOf(Interval const& interval) const;
+
+    std::vector<std::string> m_labels;
+    std::vector<Marker> m_markers;
+    std::vector<std::pair<std::uint32_t, std::int64_t>> m_counterValues;
+
+    std::vector<Interval> m_intervals;
+    std::vector<Interval> m_cycles;
+    /* indices into m_cycles per runtime name */
+    std::map<std::string, std::vector<std::size_t>> m_runtimeCycles;
+    /* indices into m_intervals per cycle */
+    std::vector<std::vector<std::size_t>> m_cycleModules;
+    std::map<std::string, LabelStats> m_stats;
+    std::map<std::string, CounterStats> m_counters;
+    std::vector<ThreadStats> m_threads;
+    lms::Time m_begin;
+    lms::Time m_end;
+};
+
+}  // namespace internal
+}  // namespace lms
+
+#endif // LMS_INTERNAL_PROFILE_ANALYZER_H
@@ -7,8 +7,13 @@
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <cstdint>
 
 #include "lms/time.h"
+#include "channel_stats.h"
+#include "telemetry.h"
+#include "thread_slot.h"
 
 namespace lms {
 namespace internal {
@@ -25,69 +30,327 @@ class DebugServer;
  * doProcess(); // execute process
  * profiler.markEnd("MyProcess");
  * ~~~
+ *
+ * Labels that are marked repeatedly should be registered once with label()
+ * and marked by id, which neither builds nor hashes strings.
  */
 class Profiler {
 public:
     /**
      * @brief Create a disabled profiler.
      *
-     * markBegin/markEnd are a no-op in diabled mode.
-     * Enable the profiler with the enable() method.
+     * markBegin/markEnd are a no-op until a listener is appended. The
+     * level is FULL by default.
      */
     Profiler();
+    ~Profiler();
+
+    typedef std::uint32_t LabelId;
+
+    /**
+     * @brief Maximum number of distinct labels. Further labels are all
+     * mapped to the last id.
+     */
+    static constexpr LabelId MAX_LABELS = 1 << 16;
+
+    /**
+     * @brief Return the id of a label, register it if it is new.
+     *
+     * This method is thread-safe but takes a lock.
+     */
+    LabelId label(const std::string &name);
+
+    /**
+     * @brief Name of a registered label. Lock-free, the reference stays
+     * valid as long as the profiler.
+     */
+    const std::string& labelName(LabelId id) const;
+
+    /**
+     * @brief How much is reported to the listeners.
+     */
+    enum class Level : std::uint8_t {
+        /** nothing */
+        OFF = 0,
+        /** runtime cycles and their counters, no modules */
+        CYCLES,
+        /** everything, but only every n-th cycle, see sampleInterval() */
+        SAMPLED,
+        /** everything */
+        FULL
+    };
+
+    /**
+     * @brief Scope of a marker, decides on which levels it is reported.
+     */
+    enum Scope : std::uint8_t {
+        CYCLE = 1, MODULE = 2
+    };
+
+    /**
+     * @brief Request another level, can be called at any time from any
+     * thread and even from a signal handler.
+     *
+     * The level takes effect with the next applyLevel(), so a process that
+     * is running meanwhile is reported with both or none of its markers.
+     */
+    void level(Level level);
+
+    /**
+     * @brief Level that was requested last.
+     */
+    Level level() const;
+
+    /**
+     * @brief Report only every n-th cycle on level SAMPLED. Takes effect
+     * with the next applyLevel() like level().
+     */
+    void sampleInterval(std::uint32_t n);
+
+    std::uint32_t sampleInterval() const;
+
+    /**
+     * @brief Apply the requested level and sample interval. Called by each
+     * runtime before it begins a cycle. Markers of other runtimes that
+     * are in the middle of a cycle may still be unbalanced.
+     */
+    void applyLevel();
+
+    /**
+     * @brief Parse "off", "cycles", "sampled" or "full".
+     * @return false if the name is unknown
+     */
+    static bool levelFromName(const std::string &name, Level &level);
+
+    static std::string levelName(Level level);
 
     /**
      * @brief Mark the begin of a process identified by a label.
      * @param label the same label should be used in markEnd()
+     * @param scope CYCLE for whole runtime cycles
      */
+    void markBegin(LabelId label, Scope scope = MODULE) {
+        if(m_mask.load(std::memory_order_relaxed) & scope) {
+            mark(BEGIN, label);
+        }
+    }
+
     void markBegin(const std::string &label);
 
     /**
      * @brief Mark the end of a process identified by a label.
      * @param label the same label that was used in markBegin()
+     * @param scope the same scope that was used in markBegin()
      */
+    void markEnd(LabelId label, Scope scope = MODULE) {
+        if(m_mask.load(std::memory_order_relaxed) & scope) {
+            mark(END, label);
+        }
+    }
+
     void markEnd(const std::string &label);
 
+    /**
+     * @brief Report the access statistics of a data channel for the cycle
+     * that just ended.
+     * @param label runtime and channel name, e.g. "default.IMAGE"
+     * @param values counters of the cycle
+     */
+    void channelStats(const std::string &label, ChannelStats::Values const& values);
+    void channelStats(LabelId label, ChannelStats::Values const& values);
+
+    /**
+     * @brief Report the current value of a counter, e.g. the cycle time of
+     * a runtime.
+     * @param label counter name, the part after the last dot names the
+     * value and should include its unit, e.g. "default.cycle time (us)"
+     * @param value counter value
+     * @param scope CYCLE for counters of whole runtime cycles, MODULE for
+     * counters of single modules
+     */
+    void counter(LabelId label, std::int64_t value, Scope scope = CYCLE) {
+        if(m_mask.load(std::memory_order_relaxed) & scope) {
+            reportCounter(label, value);
+        }
+    }
+
+    /**
+     * @brief Check if any listener is attached and the level is not OFF.
+     */
+    bool enabled() const {
+        return m_mask.load(std::memory_order_relaxed) != 0;
+    }
+
+    /**
+     * @brief Set the cycle the calling thread is working on. Listeners can
+     * read it with currentCycle().
+     */
+    static void currentCycle(int cycle);
+
+    /**
+     * @brief Cycle the calling thread is working on, -1 if unknown.
+     */
+    static int currentCycle();
+
     enum Type : std::uint8_t {
-        BEGIN = 0, END, MAPPING
+        BEGIN = 0, END, MAPPING, CHANNEL_STATS, COUNTER
     };
 
     class ProfilingListener {
     public:
         virtual ~ProfilingListener() {}
-        virtual void onMarker(Type type, lms::Time now, std::string const& label) =0;
+
+        /**
+         * @brief Called once for every label, before it is used in any
+         * marker. Labels registered before the listener was appended are
+         * replayed. Ignored by default.
+         */
+        virtual void onLabel(LabelId id, std::string const& label) {
+            (void)id;
+            (void)label;
+        }
+
+        /**
+         * @param id label id
+         * @param label name of the label, for listeners without a mapping
+         */
+        virtual void onMarker(Type type, lms::Time now, LabelId id,
+                              std::string const& label) =0;
+
+        /**
+         * @brief Called once per cycle and channel if channel statistics
+         * are enabled. Ignored by default.
+         */
+        virtual void onChannelStats(lms::Time now, LabelId id, std::string const& label,
+                                    ChannelStats::Values const& values) {
+            (void)now;
+            (void)id;
+            (void)label;
+            (void)values;
+        }
+
+        /**
+         * @brief Called for every Profiler::counter() report. Ignored by
+         * default.
+         */
+        virtual void onCounter(lms::Time now, LabelId id, std::string const& label,
+                               std::int64_t value) {
+            (void)now;
+            (void)id;
+            (void)label;
+            (void)value;
+        }
     };
 
     void appendListener(ProfilingListener *listener);
 private:
-    void mark(Type type, const std::string& label);
+    static constexpr LabelId LABEL_BLOCK = 256;
+
+    /* set in m_mask on level SAMPLED */
+    static constexpr std::uint8_t SAMPLED_MASK = 4;
+
+    void mark(Type type, LabelId label);
+    void reportCounter(LabelId label, std::int64_t value);
+
+    /**
+     * @brief Check if the calling thread's cycle is reported on level
+     * SAMPLED.
+     */
+    bool sampledCycle() const;
 
     std::vector<std::unique_ptr<ProfilingListener>> m_listeners;
+
+    /* scopes that are reported, 0 if there are no listeners */
+    std::atomic<std::uint8_t> m_mask;
+    std::atomic<std::uint32_t> m_appliedInterval;
+
+    /* requested by level() and sampleInterval() */
+    std::atomic<Level> m_level;
+    std::atomic<std::uint32_t> m_sampleInterval;
+
+    /* label names in blocks that never move, written under m_labelsMutex */
+    std::atomic<std::string*> m_labelBlocks[MAX_LABELS / LABEL_BLOCK];
+    std::unordered_map<std::string, LabelId> m_labelIds;
+    std::mutex m_labelsMutex;
 };
 
+/**
+ * @brief Profiling listener that writes one CSV line per entry:
+ *
+ * ~~~
+ * MAPPING:       2,label id,label name
+ * BEGIN, END:    0 or 1,label id,micros since the previous marker
+ * CHANNEL_STATS: 3,label id,reads,writes,bytes,blocked micros
+ * COUNTER:       4,label id,value
+ * ~~~
+ *
+ * Each label is mapped before its first use. The first marker is relative
+ * to the creation of the listener. Threads are not recorded, use
+ * BinaryProfiler for multithreaded runtimes. lms-profile analyzes both
+ * formats.
+ */
 class FileProfiler : public Profiler::ProfilingListener {
 public:
     FileProfiler(std::string const& file);
     ~FileProfiler();
 
-    void onMarker(Profiler::Type type, lms::Time now, std::string const& label) override;
+    void onLabel(Profiler::LabelId id, std::string const& label) override;
+    void onMarker(Profiler::Type type, lms::Time now, Profiler::LabelId id,
+                  std::string const& label) override;
+    void onChannelStats(lms::Time now, Profiler::LabelId id, std::string const& label,
+                        ChannelStats::Values const& values) override;
+    void onCounter(lms::Time now, Profiler::LabelId id, std::string const& label,
+                   std::int64_t value) override;
 private:
     std::ofstream m_stream;
 
     std::mutex m_mutex;
     lms::Time m_lastTimestamp;
-
-    typedef std::unordered_map<std::string, size_t> MappingType;
-    MappingType m_stringMapping;
 };
 
+/**
+ * @brief Profiling listener that streams all records to debug server
+ * clients as TELEMETRY datagrams, see TelemetryEncoder.
+ *
+ * Records are batched and sent whenever a runtime cycle ends (the end
+ * marker of a label without a dot) or the batch is full. All label
+ * mappings are sent again whenever a new client has connected.
+ */
 class DebugServerProfiler : public Profiler::ProfilingListener {
 public:
+    /* payload size at which a batch is sent even in the middle of a cycle */
+    static constexpr std::size_t MAX_BATCH = 8192;
+
     DebugServerProfiler(DebugServer *server);
 
-    void onMarker(Profiler::Type type, lms::Time now, std::string const& label) override;
+    void onLabel(Profiler::LabelId id, std::string const& label) override;
+    void onMarker(Profiler::Type type, lms::Time now, Profiler::LabelId id,
+                  std::string const& label) override;
+    void onChannelStats(lms::Time now, Profiler::LabelId id, std::string const& label,
+                        ChannelStats::Values const& values) override;
+    void onCounter(lms::Time now, Profiler::LabelId id, std::string const& label,
+                   std::int64_t value) override;
+
+    /**
+     * @brief Send the current batch now.
+     */
+    void flush();
 private:
+    /**
+     * @brief Send the current batch, needs m_mutex.
+     */
+    void send();
+
     DebugServer * m_server;
+
+    /* thread id of the calling thread, needs m_mutex */
+    ThreadSlot<std::uint16_t, DebugServerProfiler> m_thread;
+
+    std::mutex m_mutex;
+    TelemetryEncoder m_batch;
+    std::vector<std::string> m_labels;
+    std::uint64_t m_connections;
+    std::uint16_t m_numThreads;
 };
 
 }  // namespace internal
@@ -0,0 +1,36 @@
+#ifndef LMS_INTERNAL_PROVENANCE_H
+#define LMS_INTERNAL_PROVENANCE_H
+
+#include <cstdint>
+
+#include "lms/time.h"
+
+namespace lms {
+namespace internal {
+
+/**
+ * @brief Where the data of a channel value originally came from.
+ *
+ * A channel that is written by a module without fresh inputs is a source:
+ * its provenance is its own name and write time. A module that reads fresh
+ * inputs passes the provenance of the oldest one on to the channels it
+ * writes, across runtimes and processes.
+ */
+struct Provenance {
+    Provenance() : source(0) {}
+
+    /**
+     * @brief time at which the source channel was written
+     */
+    Time origin;
+
+    /**
+     * @brief extra::stableHash() of the source channel's name, 0 if unknown
+     */
+    std::uint64_t source;
+};
+
+}  // namespace internal
+}  // namespace lms
+
+#endif // LMS_INTERNAL_PROVENANCE_H
@@ -72,6 +72,9 @@ private:
     const ArgumentHandler &m_argumentHandler;
 
     Profiler &m_profiler;
+    Profiler::LabelId m_profilingLabel;
+    Profiler::LabelId m_cycleTimeLabel;
+    Profiler::LabelId m_overflowLabel;
     ExecutionManager m_executionManager;
     Clock m_clock;
 
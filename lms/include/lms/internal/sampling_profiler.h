@@ -0,0 +1,144 @@
+#ifndef LMS_INTERNAL_SAMPLING_PROFILER_H
+#define LMS_INTERNAL_SAMPLING_PROFILER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <ostream>
+#include <condition_variable>
+#include <cstdint>
+
+#include "profiler.h"
+#include "lms/extra/bounded_queue.h"
+
+namespace lms {
+namespace internal {
+
+/**
+ * @brief Statistical profiler that periodically captures the stack of the
+ * thread that is consuming CPU time and tags it with the module that is
+ * currently executed on that thread.
+ *
+ * The module is tracked through the profiler's begin and end markers. On
+ * Unix, sampling is driven by a SIGPROF interval timer (ITIMER_PROF); the
+ * signal handler only captures raw return addresses into a lock-free queue,
+ * a background thread aggregates them. The stacks are symbolized once when
+ * the profiler is destroyed and written as folded stacks:
+ *
+ * ~~~
+ * runtime;module;outermost frame;...;innermost frame count
+ * ~~~
+ *
+ * which flamegraph.pl and most flame graph viewers read directly.
+ *
+ * Only one sampling profiler can be active at a time.
+ */
+class SamplingProfiler : public Profiler::ProfilingListener {
+public:
+    static constexpr int MAX_FRAMES = 48;
+    static constexpr std::size_t QUEUE_CAPACITY = 1024;
+
+    /**
+     * @param file folded stacks are written to this file on destruction,
+     * nothing is written if empty
+     * @param frequency samples per second of consumed CPU time
+     */
+    SamplingProfiler(std::string const& file, int frequency = 100);
+
+    /**
+     * @brief Stop sampling and write the folded stacks.
+     */
+    ~SamplingProfiler();
+
+    /**
+     * @brief Install the signal handler and start the timer.
+     *
+     * Sampling is not supported on Windows, start() always fails there.
+     *
+     * @return false if another sampling profiler is active or sampling is
+     * not supported on this platform
+     */
+    bool start();
+
+    /**
+     * @brief Stop the timer and wait for signal handlers that are still
+     * sampling on other threads. The signal handler stays installed but
+     * ignores all further signals.
+     */
+    void stop();
+
+    void onLabel(Profiler::LabelId id, std::string const& label) override;
+    void onMarker(Profiler::Type type, lms::Time now, Profiler::LabelId id,
+                  std::string const& label) override;
+
+    /**
+     * @brief Number of samples aggregated so far.
+     */
+    std::uint64_t samples();
+
+    /**
+     * @brief Number of samples that were lost because the queue was full.
+     */
+    std::uint64_t dropped() const;
+
+    /**
+     * @brief Write all samples aggregated so far as folded stacks.
+     */
+    void writeFolded(std::ostream &os);
+private:
+    struct Sample {
+        /* innermost label of the sampled thread, -1 if none */
+        std::int32_t label;
+        std::int32_t depth;
+        void *frames[MAX_FRAMES];
+    };
+
+    /**
+     * @brief Capture a sample of the calling thread, called from the
+     * signal handler.
+     */
+    void sample();
+
+    /**
+     * @brief Platform specific timer and signal handling.
+     */
+    bool startTimer();
+    void stopTimer();
+    static void handleSignal(int signal);
+    static void blockSignal();
+
+    void drainLoop();
+    void drain();
+
+    /* the profiler the signal handler reports to */
+    static std::atomic<SamplingProfiler*> s_active;
+
+    /* signal handlers that may still use the profiler they loaded from
+     * s_active, stop() waits for them */
+    static std::atomic<int> s_inHandler;
+
+    const std::string m_file;
+    const int m_frequency;
+    bool m_started;
+
+    extra::BoundedQueue<Sample> m_queue;
+    std::atomic<std::uint64_t> m_dropped;
+
+    /* everything below is protected by m_mutex */
+    std::mutex m_mutex;
+    std::vector<std::string> m_labels;
+    std::map<std::pair<std::int32_t, std::vector<void*>>, std::uint64_t> m_stacks;
+    std::uint64_t m_samples;
+
+    bool m_running;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+};
+
+}  // namespace internal
+}  // namespace lms
+
+#endif // LMS_INTERNAL_SAMPLING_PROFILER_H
@@ -0,0 +1,128 @@
+#ifndef LMS_INTERNAL_SHARED_MEMORY_SEGMENT_H
+#define LMS_INTERNAL_SHARED_MEMORY_SEGMENT_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include "provenance.h"
+
+namespace lms {
+namespace internal {
+
+/**
+ * @brief A named POSIX shared memory segment that holds the value of a
+ * single data channel.
+ *
+ * The segment starts with a versioned header that identifies the payload
+ * type and size, followed by the payload. Concurrent access is synchronized
+ * by a sequence lock: the writer makes the sequence number odd while it
+ * copies into the payload, readers retry if the sequence number was odd or
+ * changed during their copy. The writer never waits for readers.
+ *
+ * There must be at most one writing process per segment. Segments persist
+ * until they are removed (e.g. from /dev/shm), so readers may be started
+ * before or after the writer.
+ *
+ * Not supported on Windows, open() fails there.
+ */
+class SharedMemorySegment {
+public:
+    static constexpr std::uint32_t MAGIC = 0x53534d4c;  // "LMSS"
+    static constexpr std::uint32_t VERSION = 2;
+
+    struct Header {
+        std::atomic<std::uint32_t> magic;
+        std::uint32_t version;
+        std::uint64_t typeHash;
+        std::uint64_t size;
+        std::atomic<std::uint64_t> sequence;
+
+        // provenance of the payload, protected by the sequence lock
+        std::int64_t originMicros;
+        std::uint64_t originSource;
+    };
+
+    SharedMemorySegment();
+    ~SharedMemorySegment();
+
+    SharedMemorySegment(const SharedMemorySegment &) = delete;
+    SharedMemorySegment &operator=(const SharedMemorySegment &) = delete;
+
+    /**
+     * @brief Create or open the segment with the given name.
+     *
+     * If the segment exists already its header must match the given type
+     * and size.
+     *
+     * @param name segment name, must start with a slash, e.g. "/lms_pose"
+     * @param size payload size in bytes
+     * @param typeHash stable hash of the payload type
+     * @return false if the segment could not be mapped or does not match
+     */
+    bool open(const std::string &name, std::size_t size, std::uint64_t typeHash);
+
+    /**
+     * @brief Unmap the segment. The segment itself is not removed.
+     */
+    void close();
+
+    bool isOpen() const;
+
+    /**
+     * @brief Copy a new value into the segment.
+     * @param data pointer to size() bytes
+     * @param provenance origin of the value, handed over with it
+     */
+    void write(const void *data, Provenance const& provenance = Provenance());
+
+    /**
+     * @brief Copy the latest value out of the segment if it was written
+     * since the last read.
+     *
+     * The value is copied into a scratch buffer first and only handed
+     * over if the sequence number did not change meanwhile, so data is
+     * left untouched if false is returned.
+     *
+     * @param data pointer to size() bytes
+     * @param lastSequence sequence number of the last value read by the
+     * caller, is updated on success
+     * @param provenance if not null, receives the origin of the value
+     * @return true if a new consistent value was copied, false if there is
+     * no new value or the writer was too busy to get a consistent copy
+     */
+    bool read(void *data, std::uint64_t &lastSequence,
+              Provenance *provenance = nullptr);
+
+    std::size_t size() const;
+
+    const std::string& name() const;
+
+    /**
+     * @brief Hash a type name in a way that is stable across processes.
+     */
+    static std::uint64_t hashTypeName(const std::string &typeName);
+
+    /**
+     * @brief Human readable description of the last error of open().
+     */
+    const std::string& error() const;
+private:
+    static constexpr int READ_RETRIES = 16;
+
+    std::string m_name;
+    std::string m_error;
+    std::size_t m_size;
+    std::size_t m_mappedSize;
+    void *m_mapped;
+    Header *m_header;
+    unsigned char *m_payload;
+    std::vector<unsigned char> m_scratch;
+};
+
+}  // namespace internal
+}  // namespace lms
+
+#endif // LMS_INTERNAL_SHARED_MEMORY_SEGMENT_H
@@ -0,0 +1,110 @@
+#ifndef LMS_INTERNAL_TELEMETRY_H
+#define LMS_INTERNAL_TELEMETRY_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "lms/time.h"
+#include "channel_stats.h"
+#include "debug_server.h"
+
+namespace lms {
+namespace internal {
+
+/**
+ * @brief Batch profiling records into a single TELEMETRY datagram of the
+ * debug server.
+ *
+ * Payload format, all integers big endian:
+ *
+ * ~~~
+ * header:  uint8 version, uint16 record count, int64 base micros
+ * records: uint8 kind followed by
+ *   BEGIN, END:    int32 micros relative to base, uint32 label,
+ *                  uint16 thread, int32 cycle
+ *   MAPPING:       uint32 label, uint8 length, label bytes
+ *   CHANNEL_STATS: int32 micros relative to base, uint32 label,
+ *                  uint64 reads, writes, bytes, int64 blocked micros
+ *   COUNTER:       int32 micros relative to base, uint32 label, int64 value
+ * ~~~
+ *
+ * Labels are sent as ids, a MAPPING record precedes the first use of each
+ * id. Clients must ignore records of unknown kinds only if the version is
+ * the one they know; a new version may change everything.
+ */
+class TelemetryEncoder {
+public:
+    static constexpr std::uint8_t VERSION = 1;
+
+    /* size of the payload header */
+    static constexpr std::size_t HEADER_LEN = 11;
+
+    /* values match Profiler::Type */
+    enum Kind : std::uint8_t {
+        BEGIN = 0, END, MAPPING, CHANNEL_STATS, COUNTER
+    };
+
+    TelemetryEncoder();
+
+    void mapping(std::uint32_t label, std::string const& name);
+    void marker(Kind kind, lms::Time time, std::uint32_t label, std::uint16_t thread,
+                std::int32_t cycle);
+    void channelStats(lms::Time time, std::uint32_t label, ChannelStats::Values const& values);
+    void counter(lms::Time time, std::uint32_t label, std::int64_t value);
+
+    /**
+     * @brief Number of records since the last finish().
+     */
+    std::uint16_t records() const;
+
+    /**
+     * @brief Payload size in bytes including the header.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Return the datagram of all records and start a new batch.
+     */
+    DebugServer::Datagram finish();
+private:
+    void begin(Kind kind);
+    void time(lms::Time time);
+
+    template<typename T>
+    void put(T value);
+
+    std::vector<std::uint8_t> m_buffer;
+    std::uint16_t m_records;
+    bool m_hasBase;
+    lms::Time m_base;
+};
+
+/**
+ * @brief Decode the payload of a TELEMETRY datagram.
+ */
+class TelemetryDecoder {
+public:
+    struct Record {
+        TelemetryEncoder::Kind kind;
+        lms::Time time;
+        std::uint32_t label;
+        std::uint16_t thread;
+        std::int32_t cycle;
+        ChannelStats::Values values;
+        std::int64_t value;
+        std::string name;
+    };
+
+    /**
+     * @brief Append all records of the payload.
+     * @return false if the version is unknown or the payload is truncated
+     */
+    static bool decode(const std::uint8_t *data, std::size_t size,
+                       std::vector<Record> &records);
+};
+
+}  // namespace internal
+}  // namespace lms
+
+#endif // LMS_INTERNAL_TELEMETRY_H
@@ -0,0 +1,70 @@
+#ifndef LMS_INTERNAL_THREAD_SLOT_H
+#define LMS_INTERNAL_THREAD_SLOT_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace lms {
+namespace internal {
+
+/**
+ * @brief Per-thread value owned by one object, e.g. the index of the
+ * calling thread in a profiling listener.
+ *
+ * All slots with the same Tag share one thread-local cache that holds the
+ * value of the slot the thread used last. Each slot gets a unique instance
+ * number, so a cache that was filled by a destroyed slot is never taken
+ * for the value of a new slot at the same address. Lookups are lock-free
+ * as long as a thread keeps using the same slot.
+ *
+ * @tparam T value type, must be default constructible
+ * @tparam Tag usually the owning class, separates the caches of unrelated
+ * slots
+ */
+template<typename T, typename Tag>
+class ThreadSlot {
+public:
+    ThreadSlot() : m_instance(nextInstance().fetch_add(1)) {}
+
+    ThreadSlot(ThreadSlot const&) = delete;
+    ThreadSlot& operator =(ThreadSlot const&) = delete;
+
+    /**
+     * @brief Value of the calling thread.
+     * @param init called with the cached value if the thread did not use
+     * this slot last, must reinitialize it completely
+     */
+    template<typename Init>
+    T& get(Init init) {
+        Cache &c = cache();
+        if(c.instance != m_instance) {
+            c.instance = m_instance;
+            init(c.value);
+        }
+        return c.value;
+    }
+private:
+    struct Cache {
+        Cache() : instance(0), value() {}
+
+        std::uint64_t instance;
+        T value;
+    };
+
+    static Cache& cache() {
+        static thread_local Cache c;
+        return c;
+    }
+
+    static std::atomic<std::uint64_t>& nextInstance() {
+        static std::atomic<std::uint64_t> next(1);
+        return next;
+    }
+
+    const std::uint64_t m_instance;
+};
+
+}  // namespace internal
+}  // namespace lms
+
+#endif // LMS_INTERNAL_THREAD_SLOT_H
@@ -0,0 +1,89 @@
+#ifndef LMS_INTERNAL_TRACE_PROFILER_H
+#define LMS_INTERNAL_TRACE_PROFILER_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <fstream>
+#include <cstdint>
+
+#include "profiler.h"
+#include "thread_slot.h"
+
+namespace lms {
+namespace internal {
+
+/**
+ * @brief Profiling listener that writes the Trace Event JSON format, which
+ * can be opened directly in chrome://tracing or the Perfetto UI.
+ *
+ * Every runtime is shown as a process, every thread that cycled modules as
+ * a thread lane of that process:
+ *
+ * - a "cycle" slice for each runtime cycle, module slices for each module
+ * - counter tracks for the runtime's cycle time and overflow
+ * - counter tracks for channel statistics if enabled (--channel-stats)
+ * - counter tracks for module allocations if enabled (--allocations)
+ *
+ * Labels are expected as "runtime" or "runtime.name", see
+ * ExecutionManager::validate(). The events are appended under a lock, use
+ * BinaryProfiler if the overhead matters.
+ */
+class TraceProfiler : public Profiler::ProfilingListener {
+public:
+    explicit TraceProfiler(std::string const& file);
+
+    /**
+     * @brief Terminate the JSON array and close the file.
+     */
+    ~TraceProfiler();
+
+    void onLabel(Profiler::LabelId id, std::string const& label) override;
+    void onMarker(Profiler::Type type, lms::Time now, Profiler::LabelId id,
+                  std::string const& label) override;
+    void onChannelStats(lms::Time now, Profiler::LabelId id, std::string const& label,
+                        ChannelStats::Values const& values) override;
+    void onCounter(lms::Time now, Profiler::LabelId id, std::string const& label,
+                   std::int64_t value) override;
+private:
+    struct Label {
+        /* index of the runtime, used as process id */
+        int pid;
+
+        /* label without the runtime prefix, empty for runtime labels */
+        std::string name;
+
+        /* argument name of counter events, the last part of the label */
+        std::string value;
+    };
+
+    /**
+     * @brief Thread lane of the calling thread, writes thread names of new
+     * lanes. Needs m_mutex.
+     */
+    int lane(int pid);
+
+    /**
+     * @brief Start a new event object with the common fields. Needs m_mutex.
+     */
+    void beginEvent(char phase, std::string const& name, lms::Time now, int pid);
+
+    std::ofstream m_stream;
+    bool m_first;
+
+    /* thread index of the calling thread, needs m_mutex */
+    ThreadSlot<int, TraceProfiler> m_tid;
+
+    std::mutex m_mutex;
+    std::vector<Label> m_labels;
+    std::vector<std::string> m_runtimes;
+
+    /* lanes that got a thread_name event, pid * 2^16 + tid */
+    std::vector<std::uint32_t> m_namedLanes;
+    int m_numThreads;
+};
+
+}  // namespace internal
+}  // namespace lms
+
+#endif // LMS_INTERNAL_TRACE_PROFILER_H
@@ -123,6 +123,10 @@ public:
     void parseService(pugi::xml_node node, const std::string &currentFile,
                       LoadConfigFlag flag);
 
+    void parseChannel(pugi::xml_node node, LoadConfigFlag flag);
+
+    void parseLatency(pugi::xml_node node, LoadConfigFlag flag);
+
     void parseFile(const std::string &file, LoadConfigFlag flag);
 
     void parseRuntime(pugi::xml_node node, const std::string &currentFile,
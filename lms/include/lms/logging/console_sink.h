@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <mutex>
+#include <ctime>
 
 #include "lms/logging/sink.h"
 
@@ -27,7 +28,7 @@ public:
      * @param out an ostream instance, e.g. std::cout or std::cerr
      */
     explicit ConsoleSink(std::ostream& out = std::cout)
-        : m_out(out), m_colored(true), m_time(true) {}
+        : m_out(out), m_colored(true), m_time(true), m_lastTime(0) {}
 
     /**
      * @brief Create a new console sink that will write into the given ostream.
@@ -38,7 +39,7 @@ public:
      * the current time
      */
     ConsoleSink(std::ostream& out, bool colored, bool time)
-        : m_out(out), m_colored(colored), m_time(time) {}
+        : m_out(out), m_colored(colored), m_time(time), m_lastTime(0) {}
 
     /**
      * @brief Log the given message to the ostream.
@@ -49,6 +50,11 @@ public:
      */
     void sink(const Event &message) override;
 
+    /**
+     * @brief Flush the ostream.
+     */
+    void flush() override;
+
     /**
      * @brief Set to true if the time should be logged.
      */
@@ -63,6 +69,10 @@ private:
     bool m_colored;
     bool m_time;
     std::mutex mtx;
+
+    /* "HH:MM:SS" of m_lastTime */
+    std::time_t m_lastTime;
+    char m_timeBuffer[10];
 };
 
 } // namespace logging
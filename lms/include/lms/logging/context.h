@@ -5,12 +5,22 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+
+#include "level.h"
+#include "lms/extra/bounded_queue.h"
 
 namespace lms {
 namespace logging {
 
 class Sink;
-class LoggingFilter;
+class Filter;
+class Event;
 
 /**
  * @brief Instantiate one logging context per application.
@@ -30,11 +40,30 @@ public:
      */
     static Context& getDefault();
 
+    /**
+     * @brief What happens to events that do not fit into the queue in
+     * async mode.
+     */
+    enum class OverflowPolicy {
+        /** wait until the background thread made room */
+        BLOCK,
+        /** drop the event that does not fit */
+        DROP_NEWEST,
+        /** drop DEBUG events once the queue is 3/4 full, others only if
+         * it is full */
+        DROP_DEBUG_FIRST
+    };
+
     /**
      * @brief Create a new context with no filters and no sinks.
      */
     Context();
 
+    /**
+     * @brief Stop the background thread and sink all queued events.
+     */
+    ~Context();
+
     /**
      * @brief Do not allow copy constructing.
      */
@@ -86,13 +115,110 @@ public:
     bool hasFilter();
 
     /**
-     * @brief Forward the logging event to all installed sinks.
+     * @brief Forward the logging event to all installed sinks, or queue it
+     * for the background thread in async mode.
      * @param message logging event
      */
     void processMessage(const Event &message);
+
+    /**
+     * @brief Switch async mode on or off.
+     *
+     * In async mode, events are pushed into a bounded lock-free queue and
+     * a background thread runs the sinks, so logging threads never wait for
+     * a sink. The filter still runs in the logging thread. Sinks must not be
+     * changed in async mode.
+     *
+     * Switching it off waits for threads that are queueing an event right
+     * now and sinks all queued events. Threads that log meanwhile sink their
+     * events themselves. async() must not be called by two threads at the
+     * same time.
+     *
+     * Each queue slot takes about 300 bytes. Tag and text of an event are
+     * copied into its slot, only events longer than that allocate.
+     *
+     * @param enable true to start the background thread
+     * @param capacity queue size, rounded up to a power of two
+     * @param policy what to do if the queue is full
+     */
+    void async(bool enable, std::size_t capacity = 4096,
+               OverflowPolicy policy = OverflowPolicy::BLOCK);
+
+    /**
+     * @brief Check if async mode is on.
+     */
+    bool async() const;
+
+    /**
+     * @brief Wait until all events queued so far are sinked. Returns
+     * immediately if async mode is off.
+     */
+    void flush();
+
+    /**
+     * @brief Number of events that were dropped because the queue was
+     * full, in total or of a single level.
+     */
+    std::uint64_t dropped() const;
+    std::uint64_t dropped(Level level) const;
 private:
+    /* tag and text are stored inline if they fit, queueing does not
+     * allocate for most events */
+    struct QueuedEvent {
+        static constexpr std::size_t INLINE_SIZE = 240;
+
+        Level level;
+        std::time_t timestamp;
+        std::uint16_t tagLength;
+        std::uint32_t textLength;
+
+        /* tag followed by text if both fit */
+        char data[INLINE_SIZE];
+
+        /* tag followed by text otherwise */
+        std::string overflow;
+
+        void assign(const std::string &tag, const std::string &text);
+        const char* begin() const;
+    };
+
+    /* sink a queued event, tag is a reused buffer */
+    void sinkQueued(QueuedEvent const& queued, std::string &tag);
+
+    /**
+     * @brief Queue the event for the background thread.
+     * @return false if async mode was switched off meanwhile, the caller
+     * must sink the event itself
+     */
+    bool enqueue(const Event &message);
+    void sink(const Event &message);
+    void drop(Level level);
+    void wake();
+    void worker();
+
     std::vector<std::unique_ptr<Sink>> m_sinks;
     std::unique_ptr<Filter> m_filter;
+
+    std::atomic<bool> m_async;
+    OverflowPolicy m_policy;
+    std::unique_ptr<extra::BoundedQueue<QueuedEvent>> m_queue;
+
+    /* threads inside enqueue(), the queue is kept until there are none */
+    std::atomic<int> m_producers;
+
+    /* indexed by level, OFF is counted as ERROR */
+    std::atomic<std::uint64_t> m_dropped[5];
+
+    /* counters for flush() */
+    std::atomic<std::uint64_t> m_enqueued;
+    std::atomic<std::uint64_t> m_processed;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_processedCv;
+    std::atomic<bool> m_sleeping;
+    bool m_running;
 };
 
 } // namespace logging
@@ -2,7 +2,11 @@
 #define LMS_LOGGING_EVENT_H
 
 #include <string>
+#include <ostream>
 #include <sstream>
+#include <memory>
+#include <ctime>
+#include <cstddef>
 
 #include "level.h"
 
@@ -19,18 +23,33 @@ class Context;
  * A log message is appendable in the following way:
  * message << "Log message No. " << 1;
  *
+ * Tag, text and stream are kept in per-thread storage that is reused by
+ * later events, and events created with new come from a per-thread free
+ * list. After the first few messages of a thread, logging does not touch
+ * the heap unless a message is longer than all messages before it.
+ *
+ * Because of this, tag and messageText() are references that are only
+ * valid as long as the event lives, e.g. during Sink::sink(). Sinks that
+ * keep them must copy them. messageStream is a plain std::ostream, use
+ * messageText() instead of messageStream.str().
+ *
  * @author Hans Kirchner
  */
 class Event {
+    struct Storage;
+
+    /* declared first, the public references below point into it */
+    Storage *m_storage;
 public:
     /**
      * @brief Create a new log message with the given values.
      * @param sink Non-null pointer to a sink implementation instance
      * @param lvl logging level
      * @param tag logging tag (used for logging hierarchies and log filtering)
+     * @param timestamp creation time, kept when the event is queued
      */
-    Event(Context &ctx, Level level, const std::string& tag)
-        : tag(tag), level(level), ctx(ctx) {}
+    Event(Context &ctx, Level level, const std::string& tag,
+          std::time_t timestamp = std::time(nullptr));
 
     /**
      * @brief The destructor will flush the log message to the
@@ -41,16 +60,31 @@ public:
      */
     ~Event();
 
+    Event(const Event&) = delete;
+    Event& operator=(const Event&) = delete;
+
     /**
-     * @brief The tag of this log message
+     * @brief Take the memory of events created with new from a per-thread
+     * free list.
      */
-    const std::string tag;
+    static void* operator new(std::size_t size);
+    static void operator delete(void *ptr);
+
+    /**
+     * @brief The tag of this log message, valid as long as the event lives
+     */
+    const std::string &tag;
 
     /**
      * @brief The log level (severity) of this log message.
      */
     const Level level;
 
+    /**
+     * @brief The time this log message was created.
+     */
+    const std::time_t timestamp;
+
     /**
      * @brief A reference to the logging context.
      *
@@ -60,18 +94,17 @@ public:
     Context &ctx;
 
     /**
-     * @brief The logging message.
+     * @brief The logging message, valid until the event is appended to or
+     * destroyed.
      */
-    std::string messageText() const {
-        return messageStream.str();
-    }
+    const std::string& messageText() const;
 
     /**
      * @brief The logging message stream.
      *
      * You can append to this stream via the << operator.
      */
-    std::ostringstream messageStream;
+    std::ostream &messageStream;
 };
 
 /**
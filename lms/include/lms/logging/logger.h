@@ -108,6 +108,10 @@ public:
      *
      * Usually you should use debug(), info(), warn() or error().
      *
+     * Levels below the threshold return before the tag is built. Enabled
+     * messages do not allocate once the thread logged a few messages, see
+     * Event.
+     *
      * @param lvl logging level (severity)
      * @param tag logging tag
      * @return an appendable logging message that will be automatically flushed
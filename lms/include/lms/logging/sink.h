@@ -28,6 +28,12 @@ public:
      * @param message a log message to write
      */
     virtual void sink(const Event &message) = 0;
+
+    /**
+     * @brief Write out buffered messages. Called after each message, or
+     * after each batch of messages in async mode.
+     */
+    virtual void flush() {}
 };
 
 } // namespace logging
@@ -1,11 +1,22 @@
 #ifndef LMS_MESSAGING_H
 #define LMS_MESSAGING_H
 
-#include <map>
-#include <list>
 #include <mutex>
 #include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <typeinfo>
+#include <type_traits>
+#include <streambuf>
+#include <istream>
+#include <ostream>
 #include "pugixml.hpp"
+#include "lms/serializable.h"
+#include "lms/extra/bounded_queue.h"
 
 namespace lms {
 
@@ -16,17 +27,228 @@ namespace lms {
  * Messages will be queued for one cycle and can be received in
  * the next cycle.
  *
+ * Commands are interned to integer ids. Modules should look up their
+ * ids once, e.g. in initialize(), and use the id based send and receive
+ * methods in cycle(). The string based methods are kept for convenience
+ * and take a lock to look up the id.
+ *
+ * Besides strings, messages can carry typed payloads: trivially copyable
+ * structs are copied byte-wise, Serializable objects are serialized. The
+ * payloads are stored in per-cycle buffers that keep their memory, so
+ * sending a payload does not allocate memory once the buffers are warm.
+ *
+ * Modules that do not cycle every cycle can subscribe to a command
+ * instead. Each subscription has its own bounded queue that keeps messages
+ * until they are popped; messages that do not fit are counted as dropped.
+ *
+ * Each worker thread of the execution manager appends to its own send
+ * buffer, so sending never locks. Messages from the same thread keep
+ * their order, messages from different threads are ordered by thread.
+ *
  * The class is thread-safe if used correctly: Do not call
- * resetQueue() outside of ExecutionManager. The send/receive
+ * resetQueue() and workers() outside of ExecutionManager. The send/receive
  * methods can be called in the cycle methods of modules.
  */
 class Messaging {
 public:
+    typedef std::uint32_t CommandId;
+
+    /**
+     * @brief Read-only view on the contents of all messages that were
+     * received for a command. Valid until the next resetQueue().
+     */
+    class MessageView {
+    public:
+        typedef const std::string* const_iterator;
+
+        MessageView() : m_begin(nullptr), m_end(nullptr) {}
+        MessageView(const std::string *begin, const std::string *end)
+            : m_begin(begin), m_end(end) {}
+
+        const_iterator begin() const { return m_begin; }
+        const_iterator end() const { return m_end; }
+
+        std::size_t size() const { return m_end - m_begin; }
+        bool empty() const { return m_begin == m_end; }
+
+        const std::string& operator[](std::size_t index) const {
+            return m_begin[index];
+        }
+
+        const std::string& front() const { return *m_begin; }
+        const std::string& back() const { return *(m_end - 1); }
+    private:
+        const std::string *m_begin;
+        const std::string *m_end;
+    };
+
+    /**
+     * @brief Typed content of a single message.
+     */
+    class Payload {
+    public:
+        Payload() : m_typeHash(0), m_data(nullptr), m_size(0) {}
+        Payload(std::size_t typeHash, const unsigned char *data, std::size_t size)
+            : m_typeHash(typeHash), m_data(data), m_size(size) {}
+
+        /**
+         * @brief Check if the payload was sent with the given type.
+         */
+        template<typename T>
+        bool is() const {
+            return m_typeHash == typeid(T).hash_code();
+        }
+
+        /**
+         * @brief Access a trivially copyable payload without copying it.
+         * @return nullptr if the payload has another type
+         */
+        template<typename T>
+        const T* get() const {
+            static_assert(std::is_trivially_copyable<T>::value,
+                          "Use deserialize() for Serializable payloads");
+            return is<T>() ? reinterpret_cast<const T*>(m_data) : nullptr;
+        }
+
+        /**
+         * @brief Deserialize a Serializable payload into the given object.
+         * @return false if the payload has another type
+         */
+        template<typename T>
+        bool deserialize(T &value) const {
+            static_assert(std::is_base_of<Serializable, T>::value,
+                          "Use get() for trivially copyable payloads");
+            if(! is<T>()) {
+                return false;
+            }
+            InputBuffer buffer(m_data, m_size);
+            std::istream is(&buffer);
+            value.lmsDeserialize(is);
+            return true;
+        }
+
+        const unsigned char* data() const { return m_data; }
+        std::size_t size() const { return m_size; }
+    private:
+        /* stream buffer that reads from the payload memory */
+        struct InputBuffer : public std::streambuf {
+            InputBuffer(const unsigned char *data, std::size_t size) {
+                char *begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+                setg(begin, begin, begin + size);
+            }
+        };
+
+        std::size_t m_typeHash;
+        const unsigned char *m_data;
+        std::size_t m_size;
+    };
+
+    /**
+     * @brief Read-only view on all payloads that were received for a
+     * command. Valid until the next resetQueue().
+     */
+    class PayloadView {
+    public:
+        typedef const Payload* const_iterator;
+
+        PayloadView() : m_begin(nullptr), m_end(nullptr) {}
+        PayloadView(const Payload *begin, const Payload *end)
+            : m_begin(begin), m_end(end) {}
+
+        const_iterator begin() const { return m_begin; }
+        const_iterator end() const { return m_end; }
+
+        std::size_t size() const { return m_end - m_begin; }
+        bool empty() const { return m_begin == m_end; }
+
+        const Payload& operator[](std::size_t index) const {
+            return m_begin[index];
+        }
+    private:
+        const Payload *m_begin;
+        const Payload *m_end;
+    };
+
+private:
+    struct Subscriber {
+        Subscriber(CommandId command, std::size_t capacity)
+            : command(command), queue(capacity), drops(0) {}
+
+        CommandId command;
+        extra::BoundedQueue<std::string> queue;
+        std::atomic<std::uint64_t> drops;
+    };
+public:
+    /**
+     * @brief Handle on a bounded queue that receives all string messages of
+     * a command. The subscription ends when the last copy of the handle is
+     * destroyed.
+     *
+     * Popping is thread-safe, messages are delivered in resetQueue().
+     */
+    class Subscription {
+    public:
+        Subscription() {}
+        explicit Subscription(std::shared_ptr<Subscriber> subscriber)
+            : m_subscriber(subscriber) {}
+
+        /**
+         * @brief Pop the oldest queued message.
+         * @return false if the queue is empty
+         */
+        bool pop(std::string &content) {
+            return m_subscriber && m_subscriber->queue.pop(content);
+        }
+
+        /**
+         * @brief Pop up to max queued messages, oldest first.
+         * @return number of messages appended to contents
+         */
+        std::size_t popAll(std::vector<std::string> &contents,
+                           std::size_t max = std::numeric_limits<std::size_t>::max()) {
+            return m_subscriber ? m_subscriber->queue.popAll(contents, max) : 0;
+        }
+
+        /**
+         * @brief Approximate number of queued messages.
+         */
+        std::size_t size() const {
+            return m_subscriber ? m_subscriber->queue.sizeApprox() : 0;
+        }
+
+        /**
+         * @brief Number of messages that were dropped because the queue
+         * was full.
+         */
+        std::uint64_t dropped() const {
+            return m_subscriber ? m_subscriber->drops.load(std::memory_order_relaxed) : 0;
+        }
+
+        explicit operator bool() const {
+            return static_cast<bool>(m_subscriber);
+        }
+    private:
+        std::shared_ptr<Subscriber> m_subscriber;
+    };
+
+    static constexpr std::size_t DEFAULT_SUBSCRIPTION_CAPACITY = 64;
+
     /**
      * @brief Empty default constructor. Only needed for MSVC.
      */
     Messaging();
 
+    /**
+     * @brief Return the id of the given command, assign a new one if
+     * the command was never used before.
+     *
+     * This method is thread-safe but takes a lock.
+     *
+     * @param command message identifier
+     * @return id that is valid as long as this messaging instance
+     */
+    CommandId command(const std::string &command);
+
     /**
      * @brief Send a message with the specified command and content.
      *
@@ -36,38 +258,228 @@ public:
      * @param command message identifier
      * @param content message content
      */
+    void send(CommandId command, const std::string &content = "");
+
     void send(const std::string &command, const std::string &content = "");
 
     /**
-     * @brief Receive all messages with the given command name that are currently
-     * queued.
+     * @brief Send a message with a typed payload.
+     *
+     * The payload is copied, the caller may modify it afterwards.
+     *
+     * @param command message identifier
+     * @param payload trivially copyable or Serializable object
+     */
+    template<typename T>
+    void sendPayload(CommandId command, const T &payload) {
+        static_assert(std::is_trivially_copyable<T>::value ||
+                      std::is_base_of<Serializable, T>::value,
+                      "Payloads must be trivially copyable or Serializable");
+        static_assert(alignof(T) <= PAYLOAD_ALIGNMENT, "Payload is over-aligned");
+
+        BufferLock lock(*this);
+        writePayload(lock.buffer(), payload, std::is_trivially_copyable<T>());
+        appendPayload(lock.buffer(), command, typeid(T).hash_code());
+    }
+
+    /**
+     * @brief Receive all payloads with the given command that were sent in
+     * the previous cycle. String messages are not included.
+     *
+     * @param command message identifier
+     * @return queued payloads, check their type with Payload::is()
+     */
+    PayloadView receivePayloads(CommandId command) const;
+
+    /**
+     * @brief Receive all messages with the given command that were sent in
+     * the previous cycle.
      *
      * This will not delete any of the queued messages.
      *
      * @param command message identifier
-     * @return queued messages (list of message contents)
+     * @return queued messages (view on the message contents)
+     */
+    MessageView receive(CommandId command) const;
+
+    MessageView receive(const std::string &command) const;
+
+    /**
+     * @brief Subscribe to all string messages with the given command.
+     *
+     * Messages are delivered to the subscription in resetQueue(), i.e. at
+     * the same time they become receivable. Payloads are not delivered.
+     *
+     * @param command message identifier
+     * @param capacity maximum number of queued messages, rounded up to a
+     * power of two
+     * @return subscription handle, keep it as long as messages should be
+     * delivered
      */
-    const std::list<std::string>& receive(const std::string &command) const;
+    Subscription subscribe(CommandId command,
+                           std::size_t capacity = DEFAULT_SUBSCRIPTION_CAPACITY);
+
+    Subscription subscribe(const std::string &command,
+                           std::size_t capacity = DEFAULT_SUBSCRIPTION_CAPACITY);
 
     /**
-     * @brief Delete all queued messages.
+     * @brief Make all messages of the current cycle receivable and delete
+     * the messages of the previous cycle.
      *
      * This should be called after each cycle method in the ExecutionManager.
      */
     void resetQueue();
+
+    /**
+     * @brief Create one send buffer for each worker thread.
+     *
+     * Must not be called while modules are cycling.
+     *
+     * @param num number of worker threads, including the main thread
+     */
+    void workers(int num);
+
+    /**
+     * @brief Number of send buffers for worker threads.
+     */
+    int workers() const;
+
+    /**
+     * @brief Set the index of the calling worker thread.
+     *
+     * Threads with an index that has no send buffer (e.g. -1) fall back to
+     * a shared buffer that is protected by a lock.
+     *
+     * @param index worker index, starting with 0
+     */
+    static void currentWorker(int index);
 private:
-    typedef std::map<std::string, std::list<std::string>> MessageQueue;
+    static constexpr std::size_t PAYLOAD_ALIGNMENT = alignof(std::max_align_t);
+
+    struct Message {
+        CommandId command;
+        std::string content;
+
+        /* payload messages have no content but a typed range in bytes */
+        bool isPayload;
+        std::size_t typeHash;
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    struct SendBuffer {
+        SendBuffer() : used(0), payloadStart(0) {}
+
+        /* messages are reused across cycles to keep their memory */
+        std::vector<Message> messages;
+        std::size_t used;
+
+        /* payloads of the current cycle, starting at aligned offsets */
+        std::vector<unsigned char> bytes;
+        std::size_t payloadStart;
+
+        /* keep buffers of different threads on different cache lines */
+        char padding[64];
+    };
+
+    /* stream buffer that appends to the payload bytes of a send buffer */
+    struct OutputBuffer : public std::streambuf {
+        explicit OutputBuffer(std::vector<unsigned char> &bytes) : m_bytes(bytes) {}
+    protected:
+        int_type overflow(int_type c) override {
+            if(! traits_type::eq_int_type(c, traits_type::eof())) {
+                m_bytes.push_back(static_cast<unsigned char>(c));
+            }
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char *s, std::streamsize n) override {
+            m_bytes.insert(m_bytes.end(), s, s + n);
+            return n;
+        }
+    private:
+        std::vector<unsigned char> &m_bytes;
+    };
+
+    /**
+     * @brief Copy the receivable messages into the subscriber queues and
+     * remove subscribers without handles.
+     */
+    void deliver();
+
+    void append(SendBuffer &buffer, CommandId command, const std::string &content);
+
+    /**
+     * @brief Send buffer of the calling thread, locks the shared buffer
+     * while in scope if the thread is not a worker.
+     */
+    class BufferLock {
+    public:
+        explicit BufferLock(Messaging &messaging);
+        ~BufferLock();
+
+        SendBuffer& buffer() {
+            return *m_buffer;
+        }
+    private:
+        Messaging &m_messaging;
+        SendBuffer *m_buffer;
+    };
+
+    /**
+     * @brief Start a new payload at an aligned offset.
+     */
+    void beginPayload(SendBuffer &buffer);
+
+    /**
+     * @brief Register the payload that was written since beginPayload().
+     */
+    void appendPayload(SendBuffer &buffer, CommandId command, std::size_t typeHash);
+
+    template<typename T>
+    void writePayload(SendBuffer &buffer, const T &payload, std::true_type) {
+        beginPayload(buffer);
+        const unsigned char *data = reinterpret_cast<const unsigned char*>(&payload);
+        buffer.bytes.insert(buffer.bytes.end(), data, data + sizeof(T));
+    }
+
+    template<typename T>
+    void writePayload(SendBuffer &buffer, const T &payload, std::false_type) {
+        beginPayload(buffer);
+        OutputBuffer out(buffer.bytes);
+        std::ostream os(&out);
+        payload.lmsSerialize(os);
+    }
+
+    /* one buffer per worker thread */
+    std::vector<SendBuffer> m_buffers;
+
+    /* buffer for all other threads, protected by m_sharedMutex */
+    SendBuffer m_shared;
+    std::mutex m_sharedMutex;
+
+    /* interned command names, protected by m_commandsMutex */
+    std::unordered_map<std::string, CommandId> m_commandIds;
+    mutable std::mutex m_commandsMutex;
+
+    /* contents of all receivable messages, grouped by command */
+    std::vector<std::string> m_contents;
 
-    /* messages that were sent in the previous cycle that can now be received */
-    MessageQueue receiveQueue;
+    /* messages of command i are m_contents[m_offsets[i]] to m_offsets[i+1] */
+    std::vector<std::size_t> m_offsets;
 
-    /* messages that were sent in the current cycle */
-    MessageQueue sendQueue;
+    /* payloads of all receivable messages, grouped by command */
+    std::vector<Payload> m_payloads;
+    std::vector<std::size_t> m_payloadOffsets;
+    std::vector<unsigned char> m_payloadBytes;
 
-    const std::list<std::string> emptyStringList;
+    /* next free position per command, only used in resetQueue() */
+    std::vector<std::size_t> m_cursors;
+    std::vector<std::size_t> m_payloadCursors;
 
-    /* mutex for sendQueue */
-    std::mutex mtx;
+    /* all subscriptions, protected by m_subscribersMutex */
+    std::vector<std::shared_ptr<Subscriber>> m_subscribers;
+    std::mutex m_subscribersMutex;
 };
 
 }  // namespace lms
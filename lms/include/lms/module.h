@@ -12,6 +12,9 @@
 #include "module_config.h"
 #include "messaging.h"
 #include "data_channel.h"
+#include "queue_channel.h"
+#include "buffer_pool.h"
+#include "extra/latency_histogram.h"
 #include "deprecated.h"
 #include "lms/definitions.h"
 #include "lms/service_handle.h"
@@ -313,6 +316,32 @@ protected:
      */
     Messaging* messaging() const { return m_messaging; }
 
+    /**
+     * @brief Subscribe to messages of the given command.
+     *
+     * Messages are kept in the subscription's queue until popped, even if
+     * this module does not cycle every cycle.
+     *
+     * @param command message identifier
+     * @param capacity maximum number of queued messages
+     * @param runtime name of the runtime whose messages should be delivered,
+     * empty for the module's own runtime
+     * @return subscription handle, empty if the runtime was not found
+     */
+    Messaging::Subscription subscribe(std::string const& command,
+        std::size_t capacity = Messaging::DEFAULT_SUBSCRIPTION_CAPACITY,
+        std::string const& runtime = "");
+
+    /**
+     * @brief Latency histogram of a module or of whole runtime cycles over
+     * the last seconds. Requires --histograms on the command line.
+     *
+     * @param hist output histogram in microseconds
+     * @param label "runtime.module", "runtime" or empty for this module
+     * @return false if histograms are disabled or the label is unknown
+     */
+    bool latencyHistogram(extra::LatencyHistogram &hist, std::string const& label = "") const;
+
     /**
      * @brief Check if --enable-save was given on the command line.
      * @return true if set, false otherwise
@@ -426,6 +455,78 @@ protected:
         return m_datamanager->writeChannel<T>(m_wrapper, name);
     }
 
+    /**
+     * @brief Read a queue channel and return a corresponding handle.
+     *
+     * Queue channels carry any number of items per cycle instead of a single
+     * value. The capacity is given by <channel name="..." queueCapacity="..."/>
+     * in the config. Queue channels can be imported from other runtimes
+     * just like normal channels.
+     *
+     * @param name channel name
+     * @return queue channel handle
+     */
+    template<typename T>
+    ReadQueueChannel<T> readQueue(const std::string &name) {
+        return m_datamanager->readQueue<T>(m_wrapper, name);
+    }
+
+    /**
+     * @brief Write a queue channel and return a corresponding handle.
+     *
+     * If more than one module writes the same queue channel the queue
+     * switches from single producer to multi producer mode.
+     *
+     * @param name channel name
+     * @return queue channel handle
+     */
+    template<typename T>
+    WriteQueueChannel<T> writeQueue(const std::string &name) {
+        return m_datamanager->writeQueue<T>(m_wrapper, name);
+    }
+
+    /**
+     * @brief Return the buffer pool of a data channel.
+     *
+     * Writers acquire buffers from the pool instead of allocating new ones
+     * each cycle. A channel of type PooledBuffer<T> then carries the handle
+     * to the current buffer:
+     *
+     * ~~~~~{.cpp}
+     * // initialize()
+     * pool = bufferPool<Image>("IMAGE", [](Image &img) { img.reserve(1 << 20); });
+     * image = writeChannel<lms::PooledBuffer<Image>>("IMAGE");
+     *
+     * // cycle()
+     * lms::PooledBuffer<Image> frame = pool->acquire();
+     * fill(*frame);
+     * *image = frame;
+     * ~~~~~
+     *
+     * The number of buffers is given by <channel name="..." poolSize="..."/>
+     * in the config.
+     *
+     * @param name channel name
+     * @param init called once for each new buffer
+     * @return pool shared by all modules of the runtime or nullptr if the
+     * pool was created with another type
+     */
+    template<typename T>
+    std::shared_ptr<BufferPool<T>> bufferPool(const std::string &name,
+                                              std::function<void(T&)> init = nullptr) {
+        return m_datamanager->bufferPool<T>(m_wrapper, name, init);
+    }
+
+    /**
+     * @brief Let the framework skip cycle() if none of the channels this
+     * module reads was written since its last cycle.
+     *
+     * Modules without any read channels are always cycled.
+     *
+     * @param skip true to enable skipping
+     */
+    void skipIfUnchanged(bool skip);
+
     /**
      * @brief Pause a running runtime or do nothing if already pausing.
      *
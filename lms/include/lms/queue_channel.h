@@ -0,0 +1,114 @@
+#ifndef LMS_QUEUE_CHANNEL_H
+#define LMS_QUEUE_CHANNEL_H
+
+#include <memory>
+#include <vector>
+#include <limits>
+#include "lms/data_channel.h"
+#include "lms/extra/bounded_queue.h"
+
+namespace lms {
+
+/**
+ * @brief Value type of queue channels, a shared handle to a bounded
+ * lock-free queue.
+ *
+ * Copies refer to the same queue. This is how queue channels are shared
+ * with other runtimes: the importing runtime receives a copy of the handle
+ * and pops from the producer's queue.
+ *
+ * Use Module::writeQueue<T> and Module::readQueue<T> instead of accessing
+ * this type directly.
+ */
+template<typename T>
+class Queue {
+public:
+    extra::BoundedQueue<T>* get() const {
+        return m_queue.get();
+    }
+
+    void reset(std::size_t capacity) {
+        m_queue = std::make_shared<extra::BoundedQueue<T>>(capacity);
+    }
+private:
+    std::shared_ptr<extra::BoundedQueue<T>> m_queue;
+};
+
+/**
+ * @brief Handle for a module that pushes items into a queue channel.
+ */
+template<typename T>
+class WriteQueueChannel : public DataChannel<Queue<T>> {
+public:
+    WriteQueueChannel(std::shared_ptr<internal::DataChannelInternal> internal) :
+        DataChannel<Queue<T>>(internal) {}
+
+    WriteQueueChannel() : DataChannel<Queue<T>>(nullptr) {}
+
+    /**
+     * @brief Append an item to the queue.
+     * @return false if the queue is full and the item was dropped
+     */
+    bool push(const T &item) {
+        this->m_internal->stampWrite();
+        return this->get_()->get()->push(item);
+    }
+
+    bool push(T &&item) {
+        this->m_internal->stampWrite();
+        return this->get_()->get()->push(std::move(item));
+    }
+
+    std::size_t capacity() {
+        return this->get_()->get()->capacity();
+    }
+};
+
+/**
+ * @brief Handle for a module that pops items from a queue channel.
+ *
+ * Each item is delivered to exactly one reader. If several modules read the
+ * same queue channel they compete for the items.
+ */
+template<typename T>
+class ReadQueueChannel : public DataChannel<Queue<T>> {
+public:
+    ReadQueueChannel(std::shared_ptr<internal::DataChannelInternal> internal) :
+        DataChannel<Queue<T>>(internal) {}
+
+    ReadQueueChannel() : DataChannel<Queue<T>>(nullptr) {}
+
+    /**
+     * @brief Remove the oldest item.
+     * @return false if the queue is empty
+     */
+    bool pop(T &item) {
+        this->m_internal->countRead();
+        return this->get_()->get()->pop(item);
+    }
+
+    /**
+     * @brief Remove up to max items and append them to the given vector.
+     *
+     * Reuse the same vector in each cycle to avoid memory allocations.
+     *
+     * @return number of removed items
+     */
+    std::size_t popAll(std::vector<T> &items,
+                       std::size_t max = std::numeric_limits<std::size_t>::max()) {
+        this->m_internal->countRead();
+        return this->get_()->get()->popAll(items, max);
+    }
+
+    /**
+     * @brief Number of items waiting in the queue, not exact if the writer
+     * runs in another thread.
+     */
+    std::size_t size() {
+        return this->get_()->get()->sizeApprox();
+    }
+};
+
+}  // namespace lms
+
+#endif // LMS_QUEUE_CHANNEL_H
@@ -2,6 +2,7 @@
 #define LMS_SERIALIZABLE_H
 
 #include <iostream>
+#include <cstdint>
 
 namespace lms {
 
@@ -27,6 +28,18 @@ public:
      * @param is input stream to read from
      */
     virtual void lmsDeserialize(std::istream &is) = 0;
+
+    /**
+     * @brief Number of bytes lmsSerialize() would write, used by channel
+     * statistics. Override it if the size is cheap to compute, otherwise
+     * the value is serialized once in a while to measure it.
+     * @param size the result will be stored in this parameter
+     * @return false if the size is not known without serializing
+     */
+    virtual bool lmsSerializedSize(std::uint64_t &size) const {
+        (void)size;
+        return false;
+    }
 };
 
 }  // namespace lms
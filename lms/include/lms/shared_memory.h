@@ -0,0 +1,28 @@
+#ifndef LMS_SHARED_MEMORY_H
+#define LMS_SHARED_MEMORY_H
+
+#include <type_traits>
+#include "lms/any.h"
+
+namespace lms {
+
+/**
+ * @brief Decides if a data channel type may be placed in a POSIX shared
+ * memory segment, see the <channel sharedMemory="..."> config tag.
+ *
+ * The channel value is copied byte-wise between processes, so the type must
+ * not contain pointers or references into the memory of its process.
+ * Trivially copyable types are compatible by default. Types with a custom,
+ * process-independent layout can opt in by specializing this template:
+ *
+ * namespace lms {
+ * template<> struct SharedMemoryCompatible<MyFixedImage> : std::true_type {};
+ * }
+ */
+template<typename T>
+struct SharedMemoryCompatible : std::integral_constant<bool,
+        std::is_trivially_copyable<T>::value && !std::is_same<T, Any>::value> {};
+
+}  // namespace lms
+
+#endif // LMS_SHARED_MEMORY_H
@@ -57,6 +57,16 @@ public:
      */
     static Time now();
 
+    /**
+     * @brief CPU time consumed by the calling thread so far.
+     *
+     * Unlike now() this does not advance while the thread is blocked or
+     * preempted.
+     *
+     * @return CPU time or ZERO if not supported on this platform
+     */
+    static Time threadCpuTime();
+
     /**
      * @brief Calculate the time passed since a reference timestamp
      *
@@ -0,0 +1,111 @@
+#include "lms/extra/latency_histogram.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace lms {
+namespace extra {
+
+constexpr int LatencyHistogram::LINEAR;
+constexpr int LatencyHistogram::SUB_BITS;
+constexpr int LatencyHistogram::SUB_BUCKETS;
+constexpr int LatencyHistogram::BUCKETS;
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    m_buckets.fill(0);
+    m_count = 0;
+    m_min = std::numeric_limits<std::int64_t>::max();
+    m_max = 0;
+    m_sum = 0;
+}
+
+int LatencyHistogram::bucketOf(std::uint64_t value) {
+    if(value < static_cast<std::uint64_t>(LINEAR)) {
+        return static_cast<int>(value);
+    }
+
+    // position of the highest set bit, at least 4
+    int exponent = 63;
+    while(! (value & (std::uint64_t(1) << exponent))) {
+        exponent--;
+    }
+
+    int sub = static_cast<int>((value >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1));
+    return LINEAR + (exponent - 4) * SUB_BUCKETS + sub;
+}
+
+std::uint64_t LatencyHistogram::upperBound(int bucket) {
+    if(bucket < LINEAR) {
+        return bucket;
+    }
+
+    int exponent = (bucket - LINEAR) / SUB_BUCKETS + 4;
+    std::uint64_t sub = (bucket - LINEAR) % SUB_BUCKETS;
+    std::uint64_t width = std::uint64_t(1) << (exponent - SUB_BITS);
+    return (SUB_BUCKETS + sub) * width + width - 1;
+}
+
+void LatencyHistogram::record(std::int64_t micros) {
+    if(micros < 0) {
+        micros = 0;
+    }
+
+    m_buckets[bucketOf(static_cast<std::uint64_t>(micros))]++;
+    m_count++;
+    m_min = std::min(m_min, micros);
+    m_max = std::max(m_max, micros);
+    m_sum += micros;
+}
+
+void LatencyHistogram::merge(LatencyHistogram const& other) {
+    for(int i = 0; i < BUCKETS; i++) {
+        m_buckets[i] += other.m_buckets[i];
+    }
+    m_count += other.m_count;
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+    m_sum += other.m_sum;
+}
+
+std::uint64_t LatencyHistogram::count() const {
+    return m_count;
+}
+
+std::int64_t LatencyHistogram::min() const {
+    return m_count == 0 ? 0 : m_min;
+}
+
+std::int64_t LatencyHistogram::max() const {
+    return m_max;
+}
+
+double LatencyHistogram::mean() const {
+    return m_count == 0 ? 0 : m_sum / m_count;
+}
+
+std::int64_t LatencyHistogram::percentile(double fraction) const {
+    if(m_count == 0) {
+        return 0;
+    }
+
+    // rank of the value we are looking for, starting with 1
+    std::uint64_t rank = static_cast<std::uint64_t>(fraction * m_count + 0.5);
+    rank = std::max<std::uint64_t>(1, std::min(rank, m_count));
+
+    std::uint64_t seen = 0;
+    for(int i = 0; i < BUCKETS; i++) {
+        seen += m_buckets[i];
+        if(seen >= rank) {
+            return std::min(static_cast<std::int64_t>(upperBound(i)), m_max);
+        }
+    }
+
+    return m_max;
+}
+
+}  // namespace extra
+}  // namespace lms
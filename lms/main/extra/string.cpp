@@ -98,5 +98,14 @@ std::string versionCodeToString(uint32_t versionCode) {
             std::to_string(patch);
 }
 
+std::uint64_t stableHash(std::string const& str) {
+    std::uint64_t hash = 14695981039346656037ULL;
+    for(char c : str) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 } // namespace extra
 } // namespace lms
@@ -0,0 +1,46 @@
+#include "lms/internal/allocation_tracker.h"
+
+namespace lms {
+namespace internal {
+
+namespace {
+
+/* read from operator new, so it must be neither lazily allocated nor
+ * dynamically initialized */
+#if defined(__GNUC__)
+__attribute__((tls_model("initial-exec")))
+#endif
+thread_local AllocationTracker::Counters *currentCounters = nullptr;
+
+}  // namespace
+
+AllocationTracker::Counters& AllocationTracker::Counters::operator +=(Counters const& other) {
+    allocations += other.allocations;
+    bytes += other.bytes;
+    frees += other.frees;
+    return *this;
+}
+
+AllocationTracker::Counters* AllocationTracker::attach(Counters *counters) {
+    Counters *previous = currentCounters;
+    currentCounters = counters;
+    return previous;
+}
+
+void AllocationTracker::allocated(std::size_t size) {
+    Counters *counters = currentCounters;
+    if(counters != nullptr) {
+        counters->allocations++;
+        counters->bytes += size;
+    }
+}
+
+void AllocationTracker::freed() {
+    Counters *counters = currentCounters;
+    if(counters != nullptr) {
+        counters->frees++;
+    }
+}
+
+}  // namespace internal
+}  // namespace lms
@@ -0,0 +1,12 @@
+#include "lms/internal/allocation_tracker.h"
+
+namespace lms {
+namespace internal {
+
+bool AllocationTracker::supported() {
+    // replacing operator new in a DLL does not affect other DLLs
+    return false;
+}
+
+}  // namespace internal
+}  // namespace lms
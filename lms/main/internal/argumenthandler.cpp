@@ -47,7 +47,10 @@ ArgumentHandler::ArgumentHandler() : argLoadConfiguration(""),
     argLoggingThreshold(logging::Level::ALL), argDefinedLoggingThreshold(false),
     argQuiet(false), argUser(""),
     argMultithreaded(false), argThreadsAuto(false), argThreads(1),
-    argDebug(false), argEnableLoad(false), argEnableSave(false) {
+    argDebug(false), argEnableLoad(false), argEnableSave(false),
+    argProfilingLevel(Profiler::Level::FULL), argProfilingSample(10),
+    argChannelStats(false), argHistograms(false), argPerfCounters(false),
+    argCpuTime(false), argAllocations(false), argSamplingRate(100) {
 
     argUser = lms::extra::username();
 }
@@ -76,6 +79,16 @@ void ArgumentHandler::parseArguments(int argc, char* const*argv) {
                                           "CYCLE"};
     TCLAP::ValuesConstraint<std::string> runLevelsConstraint(runLevels);
 
+    std::vector<std::string> profilingFormats = {"csv", "binary", "trace"};
+    TCLAP::ValuesConstraint<std::string> profilingFormatConstraint(profilingFormats);
+
+    std::vector<std::string> overflowPolicies = {"block", "drop-newest",
+                                                 "drop-debug-first"};
+    TCLAP::ValuesConstraint<std::string> overflowPolicyConstraint(overflowPolicies);
+
+    std::vector<std::string> profilingLevels = {"off", "cycles", "sampled", "full"};
+    TCLAP::ValuesConstraint<std::string> profilingLevelConstraint(profilingLevels);
+
     ThreadsConstraint threadsConstraint;
 
     TCLAP::CmdLine cmd("LMS - Lightweight Modular System", ' ', LMS_VERSION_STRING);
@@ -94,6 +107,9 @@ void ArgumentHandler::parseArguments(int argc, char* const*argv) {
     TCLAP::ValueArg<std::string> logFileArg("", "log-file",
         "Log to the given file",
         false, "", "path", cmd);
+    TCLAP::ValueArg<std::string> asyncLoggingArg("", "async-logging",
+        "Run logging sinks in a background thread, the value decides what happens if its queue is full",
+        false, "", &overflowPolicyConstraint, cmd);
     TCLAP::SwitchArg quietSwitch("q", "quiet",
         "Do not log anything to stdout",
         cmd, false);
@@ -103,6 +119,36 @@ void ArgumentHandler::parseArguments(int argc, char* const*argv) {
     TCLAP::ValueArg<std::string> profilingArg("", "profiling",
         "Measure execution time of all modules and dump to a file",
         false, "", "path", cmd);
+    TCLAP::ValueArg<std::string> profilingFormatArg("", "profiling-format",
+        "Format of the --profiling file: csv, binary (lowest overhead) or trace (JSON for trace viewers)",
+        false, "csv", &profilingFormatConstraint, cmd);
+    TCLAP::ValueArg<std::string> profilingLevelArg("", "profiling-level",
+        "What is reported to profiling listeners, can be changed with SIGUSR2 or the debug server",
+        false, "full", &profilingLevelConstraint, cmd);
+    TCLAP::ValueArg<std::uint32_t> profilingSampleArg("", "profiling-sample",
+        "Report only every n-th cycle on profiling level sampled",
+        false, 10, "n", cmd);
+    TCLAP::SwitchArg histogramsSwitch("", "histograms",
+        "Keep latency histograms of all modules and runtime cycles",
+        cmd, false);
+    TCLAP::SwitchArg perfCountersSwitch("", "perf-counters",
+        "Add performance counters (cycles, cache misses, ...) to the histograms, implies --histograms",
+        cmd, false);
+    TCLAP::SwitchArg cpuTimeSwitch("", "cpu-time",
+        "Compare CPU time and wall time of all modules",
+        cmd, false);
+    TCLAP::SwitchArg allocationsSwitch("", "allocations",
+        "Count heap allocations of all modules per cycle",
+        cmd, false);
+    TCLAP::ValueArg<std::string> samplingArg("", "sampling",
+        "Sample stacks of all threads and dump them as folded stacks for flame graphs",
+        false, "", "path", cmd);
+    TCLAP::ValueArg<int> samplingRateArg("", "sampling-rate",
+        "Samples per second of CPU time, used with --sampling",
+        false, 100, "hz", cmd);
+    TCLAP::SwitchArg channelStatsSwitch("", "channel-stats",
+        "Count channel accesses and report them to the profiling listeners",
+        cmd, false);
     TCLAP::ValueArg<std::string> threadsArg("", "threads",
         "Enable multithreading, number of threads or auto",
         false, "", &threadsConstraint, cmd);
@@ -134,9 +180,20 @@ void ArgumentHandler::parseArguments(int argc, char* const*argv) {
     argUser = userArg.getValue();
     argLogFile = logFileArg.getValue();
     argQuiet = quietSwitch.getValue();
+    argAsyncLogging = asyncLoggingArg.getValue();
     argFlags = lms::extra::split(flagsArg.getValue(), ',');
     argProfilingFile = profilingArg.getValue();
+    argProfilingFormat = profilingFormatArg.getValue();
+    Profiler::levelFromName(profilingLevelArg.getValue(), argProfilingLevel);
+    argProfilingSample = profilingSampleArg.getValue();
     argDebug = debugSwitch.getValue();
+    argChannelStats = channelStatsSwitch.getValue();
+    argPerfCounters = perfCountersSwitch.getValue();
+    argHistograms = histogramsSwitch.getValue() || argPerfCounters;
+    argCpuTime = cpuTimeSwitch.getValue();
+    argAllocations = allocationsSwitch.getValue();
+    argSamplingFile = samplingArg.getValue();
+    argSamplingRate = samplingRateArg.getValue();
     runLevelByName(runLevelArg.getValue(), argRunLevel);
     if(threadsArg.isSet()) {
         argMultithreaded = true;
@@ -1,5 +1,6 @@
 #include "lms/internal/backtrace_formatter.h"
 #include <iostream>
+#include <cstdlib>
 #include <execinfo.h>
 #include <cxxabi.h>
 #include "lms/extra/type.h"
@@ -7,6 +8,44 @@
 namespace lms {
 namespace internal {
 
+namespace {
+
+/**
+ * @brief Split a line of backtrace_symbols() "binary(mangled+offset) [address]"
+ * in place.
+ * @return false if the line has no symbol
+ */
+bool splitSymbol(char *message, char *&mangledName, char *&offset, char *&rest) {
+    char *mangled_name = 0, *offset_begin = 0, *offset_end = 0;
+
+    // find parantheses and +address offset surrounding mangled name
+    for (char *p = message; *p; ++p) {
+        if (*p == '(') {
+            mangled_name = p;
+        } else if (*p == '+') {
+            offset_begin = p;
+        } else if (*p == ')') {
+            offset_end = p;
+            break;
+        }
+    }
+
+    if (mangled_name && offset_begin && offset_end &&
+        mangled_name < offset_begin) {
+        *mangled_name++ = '\0';
+        *offset_begin++ = '\0';
+        *offset_end++ = '\0';
+
+        mangledName = mangled_name;
+        offset = offset_begin;
+        rest = offset_end;
+        return true;
+    }
+    return false;
+}
+
+}  // namespace
+
 void printStacktrace() {
     // http://linux.die.net/man/3/backtrace
 
@@ -21,31 +60,14 @@ void printStacktrace() {
     char** messages = backtrace_symbols (buffer, size);
 
     for (int i = 1; i < size && messages != NULL; ++i) {
-        char *mangled_name = 0, *offset_begin = 0, *offset_end = 0;
-
-        // find parantheses and +address offset surrounding mangled name
-        for (char *p = messages[i]; *p; ++p) {
-            if (*p == '(') {
-                mangled_name = p;
-            } else if (*p == '+') {
-                offset_begin = p;
-            } else if (*p == ')') {
-                offset_end = p;
-                break;
-            }
-        }
+        char *mangled_name, *offset, *rest;
 
         // if the line could be processed, attempt to demangle the symbol
-        if (mangled_name && offset_begin && offset_end &&
-            mangled_name < offset_begin) {
-            *mangled_name++ = '\0';
-            *offset_begin++ = '\0';
-            *offset_end++ = '\0';
-
+        if (splitSymbol(messages[i], mangled_name, offset, rest)) {
             std::string realName(lms::extra::demangle(mangled_name));
 
             std::cerr << "[bt]: (" << i << ") " << messages[i] << " : "
-                      << realName << "+" << offset_begin << offset_end
+                      << realName << "+" << offset << rest
                       << std::endl;
         } else {
             // otherwise, print the whole line
@@ -59,5 +81,30 @@ void printStacktrace() {
     free (messages);
 }
 
+int captureStacktrace(void **frames, int max) {
+    return backtrace(frames, max);
+}
+
+std::string frameName(void *address) {
+    char** messages = backtrace_symbols(&address, 1);
+    if (messages == NULL) {
+        return "??";
+    }
+
+    std::string name;
+    char *mangled_name, *offset, *rest;
+    if (! splitSymbol(messages[0], mangled_name, offset, rest)) {
+        name = messages[0];
+    } else if (*mangled_name) {
+        name = lms::extra::demangle(mangled_name);
+    } else {
+        // no exported symbol, e.g. a static function
+        name = std::string(messages[0]) + "+" + offset;
+    }
+
+    free (messages);
+    return name;
+}
+
 }  // namespace internal
 }  // namespace lms
@@ -36,6 +36,25 @@ void printStacktrace() {
     free( symbol );
 }
 
+int captureStacktrace(void **frames, int max) {
+    return CaptureStackBackTrace( 0, max, frames, NULL );
+}
+
+std::string frameName(void *address) {
+    HANDLE process = GetCurrentProcess();
+    SymInitialize( process, NULL, TRUE );
+
+    SYMBOL_INFO *symbol = ( SYMBOL_INFO * )calloc( sizeof( SYMBOL_INFO ) + 256 * sizeof( char ), 1 );
+    symbol->MaxNameLen   = 255;
+    symbol->SizeOfStruct = sizeof( SYMBOL_INFO );
+
+    std::string name = SymFromAddr( process, ( DWORD64 )( address ), 0, symbol ) ?
+        symbol->Name : "??";
+
+    free( symbol );
+    return name;
+}
+
 }  // namespace internal
 }  // namespace lms
 
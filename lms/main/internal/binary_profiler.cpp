@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#include "lms/internal/binary_profiler.h"
+
+namespace lms {
+namespace internal {
+
+namespace {
+
+const char MAGIC[8] = {'L', 'M', 'S', 'P', 'R', 'O', 'F', '\0'};
+const std::uint32_t ENDIANNESS = 0x01020304;
+
+template<typename T>
+void writeValue(std::ofstream &stream, T const& value) {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+}  // namespace
+
+constexpr std::uint32_t BinaryProfiler::VERSION;
+constexpr std::size_t BinaryProfiler::RING_CAPACITY;
+
+BinaryProfiler::BinaryProfiler(std::string const& file)
+    : m_writtenLabels(0),
+      m_dropped(0), m_running(true) {
+    m_stream.open(file, std::ios::binary);
+    m_stream.write(MAGIC, sizeof(MAGIC));
+    writeValue(m_stream, VERSION);
+    writeValue(m_stream, ENDIANNESS);
+
+    m_thread = std::thread([this]() {
+        drainLoop();
+    });
+}
+
+BinaryProfiler::~BinaryProfiler() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+
+    drain();
+}
+
+BinaryProfiler::Ring& BinaryProfiler::ring() {
+    return *m_ring.get([this](Ring *&ring) {
+        // first marker of this thread, rings are never removed
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_rings.emplace_back(new Ring(static_cast<std::uint32_t>(m_rings.size())));
+        ring = m_rings.back().get();
+    });
+}
+
+void BinaryProfiler::onLabel(Profiler::LabelId id, std::string const& label) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(m_labels.size() <= id) {
+        m_labels.resize(id + 1);
+    }
+    m_labels[id] = label;
+}
+
+void BinaryProfiler::onMarker(Profiler::Type type, Time now, Profiler::LabelId id,
+                              std::string const& label) {
+    (void)label;
+    Ring &r = ring();
+
+    Record record;
+    record.micros = now.micros();
+    record.label = id;
+    record.thread = r.thread;
+    record.cycle = Profiler::currentCycle();
+    record.type = type;
+    record.value = 0;
+
+    if(! r.records.push(record)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void BinaryProfiler::onCounter(Time now, Profiler::LabelId id, std::string const& label,
+                               std::int64_t value) {
+    (void)label;
+    Ring &r = ring();
+
+    Record record;
+    record.micros = now.micros();
+    record.label = id;
+    record.thread = r.thread;
+    record.cycle = Profiler::currentCycle();
+    record.type = Profiler::COUNTER;
+    record.value = value;
+
+    if(! r.records.push(record)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void BinaryProfiler::onChannelStats(Time now, Profiler::LabelId id, std::string const& label,
+                                    ChannelStats::Values const& values) {
+    (void)label;
+    // reported once per channel and cycle, not worth a ring
+    Stats stats;
+    stats.record.micros = now.micros();
+    stats.record.label = id;
+    stats.record.type = Profiler::CHANNEL_STATS;
+    stats.values = values;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.push_back(stats);
+}
+
+std::uint64_t BinaryProfiler::dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+void BinaryProfiler::flush() {
+    drain();
+}
+
+void BinaryProfiler::drainLoop() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while(m_running) {
+        m_cv.wait_for(lock, std::chrono::milliseconds(10));
+
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+void BinaryProfiler::drain() {
+    std::lock_guard<std::mutex> drainLock(m_drainMutex);
+
+    std::vector<Ring*> rings;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(auto const& r : m_rings) {
+            rings.push_back(r.get());
+        }
+    }
+
+    // pop before copying the labels: every popped record's label was
+    // registered before the record was pushed
+    m_drained.clear();
+    for(Ring *r : rings) {
+        r->records.popAll(m_drained);
+    }
+
+    std::vector<std::string> labels;
+    m_drainedStats.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        labels.assign(m_labels.begin() + m_writtenLabels, m_labels.end());
+        m_drainedStats.swap(m_stats);
+    }
+
+    for(std::string const& label : labels) {
+        std::uint16_t length = static_cast<std::uint16_t>(
+            std::min(label.size(), std::size_t(std::numeric_limits<std::uint16_t>::max())));
+        writeValue(m_stream, static_cast<std::uint8_t>(Profiler::MAPPING));
+        writeValue(m_stream, static_cast<std::uint32_t>(m_writtenLabels++));
+        writeValue(m_stream, length);
+        m_stream.write(label.data(), length);
+    }
+
+    for(Record const& record : m_drained) {
+        writeValue(m_stream, record.type);
+        writeValue(m_stream, record.micros);
+        writeValue(m_stream, record.label);
+        writeValue(m_stream, record.thread);
+        writeValue(m_stream, record.cycle);
+        if(record.type == Profiler::COUNTER) {
+            writeValue(m_stream, record.value);
+        }
+    }
+
+    for(Stats const& stats : m_drainedStats) {
+        writeValue(m_stream, stats.record.type);
+        writeValue(m_stream, stats.record.micros);
+        writeValue(m_stream, stats.record.label);
+        writeValue(m_stream, stats.values.reads);
+        writeValue(m_stream, stats.values.writes);
+        writeValue(m_stream, stats.values.bytes);
+        writeValue(m_stream, static_cast<std::uint64_t>(stats.values.blockedMicros));
+    }
+
+    m_stream.flush();
+}
+
+bool BinaryProfileReader::open(std::string const& file) {
+    m_stream.open(file, std::ios::binary);
+    m_labels.clear();
+
+    char magic[sizeof(MAGIC)];
+    std::uint32_t version, endianness;
+    if(! m_stream.read(magic, sizeof(magic)) || ! read(version) || ! read(endianness)) {
+        return false;
+    }
+
+    return std::equal(magic, magic + sizeof(magic), MAGIC) &&
+        version == BinaryProfiler::VERSION && endianness == ENDIANNESS;
+}
+
+bool BinaryProfileReader::next(Entry &entry) {
+    std::uint8_t type;
+    while(read(type)) {
+        if(type == Profiler::MAPPING) {
+            std::uint32_t id;
+            std::uint16_t length;
+            if(! read(id) || ! read(length)) {
+                return false;
+            }
+            std::string label(length, '\0');
+            if(! m_stream.read(&label[0], length)) {
+                return false;
+            }
+            if(m_labels.size() <= id) {
+                m_labels.resize(id + 1);
+            }
+            m_labels[id] = label;
+            continue;
+        }
+
+        std::int64_t micros;
+        if(! read(micros) || ! read(entry.label)) {
+            return false;
+        }
+        entry.type = static_cast<Profiler::Type>(type);
+        entry.time = Time::fromMicros(micros);
+
+        if(type == Profiler::CHANNEL_STATS) {
+            std::uint64_t blocked;
+            entry.thread = 0;
+            entry.cycle = -1;
+            if(! read(entry.values.reads) || ! read(entry.values.writes) ||
+                    ! read(entry.values.bytes) || ! read(blocked)) {
+                return false;
+            }
+            entry.values.blockedMicros = static_cast<std::int64_t>(blocked);
+            entry.value = 0;
+            return true;
+        }
+
+        entry.values = ChannelStats::Values();
+        entry.value = 0;
+        if(! read(entry.thread) || ! read(entry.cycle)) {
+            return false;
+        }
+        return type != Profiler::COUNTER || read(entry.value);
+    }
+    return false;
+}
+
+std::string BinaryProfileReader::label(std::uint32_t id) const {
+    return id < m_labels.size() ? m_labels[id] : std::string();
+}
+
+}  // namespace internal
+}  // namespace lms
@@ -0,0 +1,191 @@
+#include "lms/internal/channel_arena.h"
+#include "lms/internal/data_channel_internal.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace lms {
+namespace internal {
+
+constexpr std::size_t ChannelArena::CACHE_LINE;
+constexpr std::size_t ChannelArena::CHUNK_SIZE;
+constexpr std::size_t ChannelArena::HUGE_PAGE_SIZE;
+
+namespace {
+
+std::size_t roundUp(std::size_t size, std::size_t multiple) {
+    return (size + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+void ObjectDeleter::operator()(ObjectBase *obj) const {
+    if(arena) {
+        obj->~ObjectBase();
+        arena->deallocate(obj, size);
+    } else {
+        delete obj;
+    }
+}
+
+ChannelArena::ChannelArena() : m_used(0), m_hugePages(false) {}
+
+ChannelArena::~ChannelArena() {
+    for(Chunk const& chunk : m_chunks) {
+#ifdef _WIN32
+        _aligned_free(chunk.memory);
+#else
+        munmap(chunk.memory, chunk.size);
+#endif
+    }
+}
+
+void ChannelArena::hugePages(bool enable) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_hugePages = enable;
+}
+
+bool ChannelArena::hugePages() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hugePages;
+}
+
+std::size_t ChannelArena::paddedSize(std::size_t size) {
+    return roundUp(size == 0 ? 1 : size, CACHE_LINE);
+}
+
+void* ChannelArena::allocate(std::size_t size, std::size_t alignment) {
+    if(alignment > CACHE_LINE) {
+        return nullptr;
+    }
+
+    size = paddedSize(size);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto freeList = m_free.find(size);
+    if(freeList != m_free.end() && ! freeList->second.empty()) {
+        void *ptr = freeList->second.back();
+        freeList->second.pop_back();
+        m_used += size;
+        return ptr;
+    }
+
+    if(m_chunks.empty() || m_chunks.back().size - m_chunks.back().used < size) {
+        if(! mapChunk(size)) {
+            return nullptr;
+        }
+    }
+
+    // chunks are page aligned and all sizes are multiples of the cache line
+    Chunk &chunk = m_chunks.back();
+    void *ptr = chunk.memory + chunk.used;
+    chunk.used += size;
+    m_used += size;
+    return ptr;
+}
+
+void ChannelArena::deallocate(void *ptr, std::size_t size) {
+    size = paddedSize(size);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_free[size].push_back(ptr);
+    m_used -= size;
+}
+
+bool ChannelArena::mapChunk(std::size_t minSize) {
+    Chunk chunk;
+    chunk.used = 0;
+    chunk.hugePages = false;
+    chunk.memory = nullptr;
+
+#ifdef _WIN32
+    chunk.size = roundUp(minSize, CHUNK_SIZE);
+    chunk.memory = static_cast<unsigned char*>(_aligned_malloc(chunk.size, CACHE_LINE));
+    if(chunk.memory == nullptr) {
+        return false;
+    }
+#else
+    if(m_hugePages) {
+        chunk.size = roundUp(minSize, HUGE_PAGE_SIZE);
+#ifdef MAP_HUGETLB
+        void *mem = mmap(nullptr, chunk.size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if(mem != MAP_FAILED) {
+            chunk.memory = static_cast<unsigned char*>(mem);
+            chunk.hugePages = true;
+        }
+#endif
+    } else {
+        chunk.size = roundUp(minSize, CHUNK_SIZE);
+    }
+
+    if(chunk.memory == nullptr) {
+        void *mem = mmap(nullptr, chunk.size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(mem == MAP_FAILED) {
+            return false;
+        }
+        chunk.memory = static_cast<unsigned char*>(mem);
+#ifdef MADV_HUGEPAGE
+        if(m_hugePages) {
+            // no reserved huge pages, ask for transparent ones instead
+            madvise(mem, chunk.size, MADV_HUGEPAGE);
+        }
+#endif
+    }
+#endif
+
+    m_chunks.push_back(chunk);
+    return true;
+}
+
+bool ChannelArena::locate(const void *ptr, std::size_t &chunk, std::size_t &offset) const {
+    const unsigned char *p = static_cast<const unsigned char*>(ptr);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(std::size_t i = 0; i < m_chunks.size(); i++) {
+        if(p >= m_chunks[i].memory && p < m_chunks[i].memory + m_chunks[i].size) {
+            chunk = i;
+            offset = p - m_chunks[i].memory;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::size_t ChannelArena::bytesUsed() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_used;
+}
+
+std::size_t ChannelArena::bytesMapped() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::size_t mapped = 0;
+    for(Chunk const& chunk : m_chunks) {
+        mapped += chunk.size;
+    }
+    return mapped;
+}
+
+std::size_t ChannelArena::chunkCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_chunks.size();
+}
+
+std::size_t ChannelArena::hugePageChunkCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::size_t count = 0;
+    for(Chunk const& chunk : m_chunks) {
+        if(chunk.hugePages) {
+            count++;
+        }
+    }
+    return count;
+}
+
+}  // namespace internal
+}  // namespace lms
@@ -0,0 +1,49 @@
+#include "lms/internal/channel_snapshot.h"
+
+namespace lms {
+namespace internal {
+
+constexpr std::uint8_t ChannelSnapshot::INDEX_MASK;
+constexpr std::uint8_t ChannelSnapshot::FRESH;
+
+ChannelSnapshot::ChannelSnapshot() : m_middle(1), m_back(0), m_front(2) {}
+
+bool ChannelSnapshot::publish(ObjectBase &source, Provenance const& provenance) {
+    if(! m_slots[0]) {
+        // allocate all buffers before the first snapshot is handed over,
+        // the consumer never touches them before that
+        for(auto &slot : m_slots) {
+            slot.reset(source.create());
+        }
+    }
+
+    if(! m_slots[m_back]->copyFrom(source)) {
+        return false;
+    }
+    m_provenance[m_back] = provenance;
+
+    std::uint8_t prev = m_middle.exchange(m_back | FRESH, std::memory_order_acq_rel);
+    m_back = prev & INDEX_MASK;
+    return true;
+}
+
+bool ChannelSnapshot::update() {
+    if(! (m_middle.load(std::memory_order_relaxed) & FRESH)) {
+        return false;
+    }
+
+    std::uint8_t prev = m_middle.exchange(m_front, std::memory_order_acq_rel);
+    m_front = prev & INDEX_MASK;
+    return true;
+}
+
+const ObjectBase& ChannelSnapshot::front() const {
+    return *m_slots[m_front];
+}
+
+Provenance const& ChannelSnapshot::frontProvenance() const {
+    return m_provenance[m_front];
+}
+
+}  // namespace internal
+}  // namespace lms
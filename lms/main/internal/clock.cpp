@@ -7,7 +7,7 @@ Clock::Clock()
     : logger("lms.Clock"), loopTime(Time::ZERO),
       m_enabledSleep(false), m_enabledSlowWarning(false),
       m_enabledCompensate(false), firstIteration(true),
-      overflowTime(Time::ZERO) {
+      overflowTime(Time::ZERO), m_lastWorkTime(Time::ZERO) {
 }
 
 void Clock::cycleTime(Time cycleTime) {
@@ -21,6 +21,7 @@ Time Clock::cycleTime() const {
 void Clock::beforeLoopIteration() {
     if(! firstIteration) {
         Time deltaWork = Time::now() - beforeWorkTimestamp;
+        m_lastWorkTime = deltaWork;
 
         if(m_enabledSlowWarning && deltaWork > loopTime && loopTime > lms::Time::ZERO) {
             float ratio = deltaWork.toFloat() / loopTime.toFloat();
@@ -54,6 +55,17 @@ void Clock::beforeLoopIteration() {
     beforeWorkTimestamp = Time::now();
 }
 
+Time Clock::lastWorkTime() const {
+    return m_lastWorkTime;
+}
+
+Time Clock::lastOverflow() const {
+    if(loopTime > Time::ZERO && m_lastWorkTime > loopTime) {
+        return m_lastWorkTime - loopTime;
+    }
+    return Time::ZERO;
+}
+
 void Clock::enabledSleep(bool flag) {
     m_enabledSleep = flag;
 }
@@ -4,50 +4,454 @@
 #include <iostream>
 #include <algorithm>
 #include <unordered_set>
+#include <streambuf>
 
 #include <lms/module.h>
 #include <lms/internal/datamanager.h>
 #include <lms/internal/executionmanager.h>
 #include <lms/internal/dot_exporter.h>
+#include <lms/internal/runtime.h>
+#include <lms/internal/framework.h>
 
 namespace lms {
 namespace internal {
 
+namespace {
+
+/**
+ * @brief Output buffer that only counts the characters written into it.
+ */
+class CountingBuffer : public std::streambuf {
+public:
+    CountingBuffer() : m_count(0) {}
+
+    std::uint64_t count() const {
+        return m_count;
+    }
+protected:
+    int_type overflow(int_type c) override {
+        if(! traits_type::eq_int_type(c, traits_type::eof())) {
+            m_count++;
+        }
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override {
+        (void)s;
+        m_count += n;
+        return n;
+    }
+private:
+    std::uint64_t m_count;
+};
+
+}  // namespace
+
 DataManager::DataManager(Runtime &runtime, ExecutionManager &execMgr)
-        : logger("lms.DataManager"), execMgr(execMgr), m_runtime(runtime) { }
+        : logger("lms.DataManager"), execMgr(execMgr), m_runtime(runtime),
+          m_cycle(-1), m_channelStats(false), m_arena(std::make_shared<ChannelArena>()) { }
+
+ChannelArena& DataManager::arena() {
+    return *m_arena;
+}
 
 const DataManager::ChannelMap &DataManager::getChannels() const {
     return channels;
 }
 
 void DataManager::releaseChannelsOf(std::shared_ptr<ModuleWrapper> module) {
-    std::vector<std::string> channelsToRemove;
+    module->inputs.clear();
+    module->outputs.clear();
 
-    for(auto &ch : channels) {
-        ch.second->readers.erase(std::remove(ch.second->readers.begin(),
-            ch.second->readers.end(), module), ch.second->readers.end());
+    auto it = m_moduleChannels.find(module.get());
+    if(it == m_moduleChannels.end()) {
+        invalidateExecutionManager();
+        return;
+    }
+
+    for(std::shared_ptr<DataChannelInternal> const& ch : it->second) {
+        if(! ch->removeModule(module)) {
+            continue;
+        }
 
-        ch.second->writers.erase(std::remove(ch.second->writers.begin(),
-            ch.second->writers.end(), module), ch.second->writers.end());
+        channels.erase(ch->name);
 
-        if(ch.second->writers.empty() && ch.second->readers.empty()) {
-            channelsToRemove.push_back(ch.first);
+        if(ch->buffered()) {
+            m_imports.erase(std::remove(m_imports.begin(), m_imports.end(), ch),
+                            m_imports.end());
         }
-    }
 
-    for(auto const& channelName : channelsToRemove) {
-        channels.erase(channelName);
+        if(ch->sharedMemory) {
+            m_sharedChannels.erase(std::remove(m_sharedChannels.begin(),
+                m_sharedChannels.end(), ch), m_sharedChannels.end());
+        }
     }
 
+    m_moduleChannels.erase(it);
+
     invalidateExecutionManager();
 }
 
+void DataManager::importChannel(std::shared_ptr<ModuleWrapper> module,
+                                std::shared_ptr<DataChannelInternal> channel) {
+    std::string hostName = module->getChannelRuntime(channel->name);
+
+    if(hostName.empty()) {
+        return;
+    }
+
+    Framework &framework = m_runtime.framework();
+
+    if(! framework.hasRuntime(hostName)) {
+        logger.error("importChannel") << "Runtime " << hostName << " for channel "
+            << channel->name << " does not exist";
+        return;
+    }
+
+    Runtime *host = framework.getRuntimeByName(hostName);
+
+    if(host == &m_runtime) {
+        logger.error("importChannel") << "Channel " << channel->name
+            << " cannot be imported from its own runtime";
+        return;
+    }
+
+    channel->snapshot = host->dataManager().exportChannel(channel->name, &m_runtime);
+    channel->dataHost = host;
+    m_imports.push_back(channel);
+}
+
+constexpr std::size_t DataManager::DEFAULT_QUEUE_CAPACITY;
+constexpr std::size_t DataManager::DEFAULT_POOL_SIZE;
+
+void DataManager::registerReader(std::shared_ptr<ModuleWrapper> const& module,
+                                 std::shared_ptr<DataChannelInternal> const& channel) {
+    if(! channel->isReaderOrWriter(module)) {
+        channel->addReader(module);
+        module->inputs.push_back(channel.get());
+        m_moduleChannels[module.get()].push_back(channel);
+        invalidateExecutionManager();
+    }
+    if(! channel->buffered()) {
+        importChannel(module, channel);
+    }
+}
+
+void DataManager::registerWriter(std::shared_ptr<ModuleWrapper> const& module,
+                                 std::shared_ptr<DataChannelInternal> const& channel) {
+    if(! channel->isReaderOrWriter(module)) {
+        channel->addWriter(module);
+        module->outputs.push_back(channel.get());
+        m_moduleChannels[module.get()].push_back(channel);
+        invalidateExecutionManager();
+    }
+    if(channel->buffered()) {
+        logger.warn("writeChannel") << module->name() << " writes into "
+            << channel->name << " which is imported from another runtime";
+    }
+}
+
+DataManager::ChannelConfig& DataManager::channelConfig(const std::string &name) {
+    return m_channelConfigs[name];
+}
+
+void DataManager::attachSharedMemory(const std::string &name,
+                                     std::shared_ptr<DataChannelInternal> channel,
+                                     std::size_t size, bool compatible) {
+    auto config = m_channelConfigs.find(name);
+    if(config == m_channelConfigs.end() || config->second.sharedMemory.empty()) {
+        return;
+    }
+
+    // the segment of the previous type is not usable anymore
+    channel->sharedMemory.reset();
+    channel->sharedSequence = 0;
+
+    std::string typeName = channel->main->typeName();
+
+    if(! compatible) {
+        logger.error("attachSharedMemory") << "Channel " << name << " of type "
+            << typeName << " cannot be placed in shared memory, specialize "
+            << "lms::SharedMemoryCompatible if its layout is process independent";
+        return;
+    }
+
+    std::unique_ptr<SharedMemorySegment> segment(new SharedMemorySegment);
+    if(! segment->open(config->second.sharedMemory, size,
+                       SharedMemorySegment::hashTypeName(typeName))) {
+        logger.error("attachSharedMemory") << "Cannot open shared memory "
+            << config->second.sharedMemory << " for channel " << name << ": "
+            << segment->error();
+        return;
+    }
+
+    channel->sharedMemory = std::move(segment);
+
+    if(std::find(m_sharedChannels.begin(), m_sharedChannels.end(), channel)
+            == m_sharedChannels.end()) {
+        m_sharedChannels.push_back(channel);
+    }
+}
+
+std::shared_ptr<ChannelSnapshot> DataManager::exportChannel(const std::string &name,
+                                                            Runtime *consumer) {
+    std::lock_guard<std::mutex> lock(m_exportsMutex);
+
+    for(Export const& exp : m_exports) {
+        if(exp.channel == name && exp.consumer == consumer) {
+            return exp.snapshot;
+        }
+    }
+
+    Export exp;
+    exp.channel = name;
+    exp.consumer = consumer;
+    exp.snapshot = std::make_shared<ChannelSnapshot>();
+    m_exports.push_back(exp);
+
+    return exp.snapshot;
+}
+
+void DataManager::beforeCycle() {
+    m_cycle = execMgr.cycleCounter();
+
+    for(auto it = m_imports.begin(); it != m_imports.end();) {
+        DataChannelInternal &ch = **it;
+
+        if(! ch.snapshot->update()) {
+            ++it;
+        } else if(ch.main->copyFrom(ch.snapshot->front())) {
+            ch.stampWrite();
+            ch.provenance = ch.snapshot->frontProvenance();
+            ++it;
+        } else {
+            logger.error("beforeCycle") << "Cannot copy snapshot of channel "
+                << ch.name << " into " << ch.main->typeName() << " from runtime "
+                << ch.dataHost->name() << ", stop importing";
+            ch.snapshot.reset();
+            ch.dataHost = nullptr;
+            it = m_imports.erase(it);
+        }
+    }
+
+    Provenance provenance;
+    for(auto const& ch : m_sharedChannels) {
+        if(ch->sharedMemory && ! ch->hasWriter() && ! ch->buffered() &&
+                ch->sharedMemory->read(ch->main->get(), ch->sharedSequence, &provenance)) {
+            ch->stampWrite();
+            ch->provenance = provenance;
+        }
+    }
+}
+
+void DataManager::enableChannelStats(bool flag) {
+    m_channelStats = flag;
+
+    for(auto const& ch : channels) {
+        if(! flag) {
+            ch.second->stats.reset();
+        } else if(! ch.second->stats) {
+            ch.second->stats.reset(newChannelStats(ch.first));
+        }
+    }
+}
+
+bool DataManager::channelStats() const {
+    return m_channelStats;
+}
+
+ChannelStats* DataManager::newChannelStats(const std::string &name) {
+    return new ChannelStats(m_runtime.profiler().label(m_runtime.name() + "." + name));
+}
+
+void DataManager::collectChannelStats() {
+    for(auto const& ch : channels) {
+        ChannelStats *stats = ch.second->stats.get();
+        if(stats == nullptr) {
+            continue;
+        }
+
+        // sizes are only reported if the value was written in this cycle
+        std::uint64_t bytes = 0;
+        if(ch.second->getCycle() == m_cycle && ch.second->main &&
+                ch.second->main->isSerializable()) {
+            const Serializable *value = ch.second->main->getSerializable();
+            if(! value->lmsSerializedSize(bytes)) {
+                // serializing large values every cycle would cost more
+                // than the modules themselves
+                if(stats->sizeOutdated(m_cycle)) {
+                    CountingBuffer buffer;
+                    std::ostream os(&buffer);
+                    value->lmsSerialize(os);
+                    stats->size(m_cycle, buffer.count());
+                }
+                bytes = stats->size();
+            }
+        }
+
+        m_runtime.profiler().channelStats(stats->label(), stats->collect(bytes));
+    }
+}
+
+void DataManager::afterCycle() {
+    if(m_channelStats) {
+        collectChannelStats();
+    }
+
+    for(auto const& ch : m_sharedChannels) {
+        if(ch->sharedMemory && ch->hasWriter()) {
+            ch->sharedMemory->write(ch->main->get(), ch->provenance);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(m_exportsMutex, std::try_to_lock);
+
+    if(! lock.owns_lock()) {
+        // another runtime is just registering, publish in the next cycle
+        return;
+    }
+
+    for(auto it = m_exports.begin(); it != m_exports.end();) {
+        if(it->snapshot.use_count() == 1) {
+            // the consumer released the channel
+            it = m_exports.erase(it);
+            continue;
+        }
+
+        ChannelMap::iterator ch = channels.find(it->channel);
+
+        if(ch != channels.end() && ch->second->main &&
+                ! it->snapshot->publish(*ch->second->main, ch->second->provenance)) {
+            logger.error("afterCycle") << "Cannot export channel " << it->channel
+                << " of type " << ch->second->main->typeName()
+                << " to runtime " << it->consumer->name() << ", type is not copyable";
+            it = m_exports.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void DataManager::traceModule(ModuleWrapper &module) {
+    // only inputs that were written in this cycle contributed to the output
+    DataChannelInternal const* oldest = nullptr;
+    for(DataChannelInternal const* ch : module.inputs) {
+        if(ch->getCycle() == m_cycle &&
+                (oldest == nullptr || ch->provenance.origin < oldest->provenance.origin)) {
+            oldest = ch;
+        }
+    }
+
+    Time now;
+    bool haveNow = false;
+
+    for(DataChannelInternal *ch : module.outputs) {
+        if(ch->getCycle() != m_cycle) {
+            continue;
+        }
+
+        // another writer may have passed on an even older origin
+        if(oldest != nullptr && oldest->provenance.origin < ch->provenance.origin) {
+            ch->provenance = oldest->provenance;
+        }
+
+        for(LatencyPath &path : m_latencyPaths) {
+            if(path.toHash == ch->nameHash && path.fromHash == ch->provenance.source) {
+                if(! haveNow) {
+                    now = Time::now();
+                    haveNow = true;
+                }
+                std::lock_guard<std::mutex> lock(m_latencyMutex);
+                path.histogram.record((now - ch->provenance.origin).micros());
+            }
+        }
+    }
+}
+
+void DataManager::traceLatency(const std::string &from, const std::string &to) {
+    for(LatencyPath const& path : m_latencyPaths) {
+        if(path.from == from && path.to == to) {
+            return;
+        }
+    }
+
+    LatencyPath path;
+    path.from = from;
+    path.to = to;
+    path.fromHash = extra::stableHash(from);
+    path.toHash = extra::stableHash(to);
+    m_latencyPaths.push_back(path);
+}
+
+bool DataManager::latency(const std::string &from, const std::string &to,
+                          extra::LatencyHistogram &histogram) {
+    std::lock_guard<std::mutex> lock(m_latencyMutex);
+
+    for(LatencyPath const& path : m_latencyPaths) {
+        if(path.from == from && path.to == to) {
+            histogram = path.histogram;
+            return true;
+        }
+    }
+    return false;
+}
+
+void DataManager::printLatencies() {
+    std::lock_guard<std::mutex> lock(m_latencyMutex);
+
+    for(LatencyPath const& path : m_latencyPaths) {
+        extra::LatencyHistogram const& hist = path.histogram;
+
+        if(hist.count() == 0) {
+            logger.info("latency") << path.from << " -> " << path.to << ": no samples";
+            continue;
+        }
+
+        logger.info("latency") << path.from << " -> " << path.to << ": "
+            << hist.count() << " samples, min " << hist.min() << " us, mean "
+            << static_cast<std::int64_t>(hist.mean()) << " us, p50 "
+            << hist.percentile(0.5) << " us, p90 " << hist.percentile(0.9)
+            << " us, p99 " << hist.percentile(0.99) << " us, max " << hist.max() << " us";
+    }
+}
+
 void DataManager::printMapping() {
+    logger.debug("mapping") << "channel arena: " << m_arena->chunkCount() << " chunks, "
+        << m_arena->bytesUsed() << " of " << m_arena->bytesMapped() << " bytes used"
+        << (m_arena->hugePages() ? ", " + std::to_string(m_arena->hugePageChunkCount())
+            + " chunks on huge pages" : "");
+
     for (auto const &ch : channels) {
         std::string channelLine = ch.first;
         channelLine = channelLine + "(" + ch.second->main->typeName() + ") :";
         logger.debug("mapping") << channelLine;
 
+        std::size_t chunk, offset;
+        if (ch.second->main.get_deleter().arena &&
+                m_arena->locate(ch.second->main.get(), chunk, offset)) {
+            logger.debug("mapping") << "    storage: chunk " << chunk << " offset " << offset
+                << ", " << ChannelArena::paddedSize(ch.second->main.get_deleter().size) << " bytes";
+        } else {
+            logger.debug("mapping") << "    storage: heap";
+        }
+
+        if (ch.second->buffered()) {
+            logger.debug("mapping") << "    imported from: " << ch.second->dataHost->name();
+        }
+
+        if (ch.second->sharedMemory) {
+            logger.debug("mapping") << "    shared memory: " << ch.second->sharedMemory->name()
+                << (ch.second->hasWriter() ? " (writing)" : " (reading)");
+        }
+
+        if (ch.second->stats && ch.second->stats->cycles() > 0) {
+            ChannelStats::Values const& total = ch.second->stats->total();
+            double cycles = ch.second->stats->cycles();
+            logger.debug("mapping") << "    per cycle: " << total.reads / cycles << " reads, "
+                << total.writes / cycles << " writes, " << total.bytes / cycles << " bytes, "
+                << total.blockedMicros / cycles << " us blocked";
+        }
+
         if (!ch.second->readers.empty()) {
             std::string readerLine = "    reading: ";
             for (std::shared_ptr<ModuleWrapper> reader : ch.second->readers) {
@@ -64,6 +468,17 @@ void DataManager::printMapping() {
             logger.debug("mapping") << writerLine;
         }
     }
+
+    for (auto const& pool : m_bufferPools) {
+        logger.debug("mapping") << pool.first << " buffer pool: " << pool.second->size()
+            << " buffers, " << pool.second->available() << " available, "
+            << pool.second->overflows() << " overflows";
+    }
+
+    std::lock_guard<std::mutex> lock(m_exportsMutex);
+    for (Export const& exp : m_exports) {
+        logger.debug("mapping") << exp.channel << " exported to: " << exp.consumer->name();
+    }
 }
 
 void DataManager::writeDAG(DotExporter &dot, const std::string &prefix) {
@@ -108,7 +523,16 @@ void DataManager::invalidateExecutionManager() {
 }
 
 void DataManager::reset() {
+    for(auto const& entry : m_moduleChannels) {
+        entry.first->inputs.clear();
+        entry.first->outputs.clear();
+    }
+
     channels.clear();
+    m_imports.clear();
+    m_sharedChannels.clear();
+    m_moduleChannels.clear();
+    m_bufferPools.clear();
 }
 
 }  // namespace internal
@@ -29,7 +29,7 @@ const uint8_t* DebugServer::Datagram::internal() const {
     return m_data.data();
 }
 
-DebugServer::DebugServer() : logger("DebugServer"), m_shutdown(false) {}
+DebugServer::DebugServer() : logger("DebugServer"), m_shutdown(false), m_connections(0) {}
 
 DebugServer::~DebugServer() {
     m_shutdown = true;
@@ -252,7 +252,9 @@ void DebugServer::processServer(int server) {
     client.sockfd = accept(server, nullptr, nullptr);
 
     if(client.sockfd != -1) {
+        std::unique_lock<std::mutex> lock(m_outMutex);
         m_clients.emplace_back(std::move(client));
+        m_connections++;
     }
 }
 
@@ -269,9 +271,40 @@ void DebugServer::processClient(Client & client) {
         client.valid = false;
     } else {
         client.bufferUsed += retval;
+        processMessages(client);
     }
 }
 
+void DebugServer::processMessages(Client & client) {
+    const size_t headerLen = sizeof(uint32_t) + sizeof(uint8_t);
+    size_t offset = 0;
+
+    while(client.bufferUsed - offset >= headerLen) {
+        const uint8_t *header = client.buffer.data() + offset;
+        uint32_t messageLen = ntohl(*reinterpret_cast<const uint32_t*>(header));
+
+        if(headerLen + messageLen > client.buffer.size()) {
+            logger.warn() << "Message of " << messageLen << " bytes is too long";
+            client.valid = false;
+            return;
+        }
+        if(client.bufferUsed - offset < headerLen + messageLen) {
+            // wait for the rest of the message
+            break;
+        }
+
+        if(m_handler) {
+            m_handler(static_cast<MessageType>(header[sizeof(uint32_t)]),
+                      header + headerLen, messageLen);
+        }
+        offset += headerLen + messageLen;
+    }
+
+    std::copy(client.buffer.begin() + offset, client.buffer.begin() + client.bufferUsed,
+              client.buffer.begin());
+    client.bufferUsed -= offset;
+}
+
 void DebugServer::processOutqueue(Client & client) {
     std::unique_lock<std::mutex> lock(m_outMutex);
     bool retry = true;
@@ -279,7 +312,7 @@ void DebugServer::processOutqueue(Client & client) {
         auto& datagram = client.outBuffer.front();
         // send in non blocking mode
         ssize_t result = send(client.sockfd, datagram.internal() + client.outOffset,
-                              datagram.size(), MSG_DONTWAIT);
+                              datagram.size() - client.outOffset, MSG_DONTWAIT);
         if(result == -1) {
             if(errno == EWOULDBLOCK) {
                 // try to write later
@@ -288,8 +321,8 @@ void DebugServer::processOutqueue(Client & client) {
                 client.valid = false;
                 perror("send");
             }
-        } else if(result < ssize_t(datagram.size())) {
-            client.outOffset = result;
+        } else if(client.outOffset + result < datagram.size()) {
+            client.outOffset += result;
             retry = false;
         } else {
             // succesful write
@@ -306,6 +339,14 @@ void DebugServer::broadcast(const Datagram &datagram) {
     }
 }
 
+void DebugServer::onMessage(MessageHandler handler) {
+    m_handler = handler;
+}
+
+std::uint64_t DebugServer::connections() const {
+    return m_connections.load();
+}
+
 void DebugServer::startThread() {
     m_thread = std::thread([this] () {
         while(! m_shutdown) {
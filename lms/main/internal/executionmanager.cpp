@@ -25,7 +25,8 @@ ExecutionManager::ExecutionManager(Profiler &profiler, Runtime &runtime)
       m_multithreading(false),
       valid(false), dataManager(runtime, *this),
       m_messaging(), m_cycleCounter(-1), running(true),
-      m_profiler(profiler), m_runtime(runtime) {
+      m_profiler(profiler), m_runtime(runtime), m_cpuTime(false),
+      m_allocations(false) {
 }
 
 ExecutionManager::~ExecutionManager () {
@@ -66,20 +67,50 @@ void ExecutionManager::loop() {
     m_messaging.resetQueue();
 
     m_cycleCounter ++;
+    Profiler::currentCycle(m_cycleCounter);
+
+    dataManager.beforeCycle();
+
+    if(m_cpuTime && m_threadCpuTime.empty()) {
+        // one slot per thread, before any worker thread runs
+        m_threadCpuTime.resize(m_multithreading ? m_numThreads + 1 : 1);
+    }
 
     //validate the ExecutionManager
     validate();
 
     if(! m_multithreading) {
+        // the main thread sends without locking, too
+        if(m_messaging.workers() < 1) {
+            m_messaging.workers(1);
+        }
+        Messaging::currentWorker(0);
+
         for(Module* mod : sortedCycleList) {
+            std::shared_ptr<ModuleWrapper> wrapper = mod->wrapper();
+
+            if(unchangedInputs(*wrapper)) {
+                if(m_runtime.framework().isDebug()) {
+                    logger.debug("skip") << mod->getName();
+                }
+                continue;
+            }
+
             m_dog.beginModule(mod->getName());
 
-            profiler().markBegin(m_runtimeName + "." + mod->getName());
+            profiler().markBegin(wrapper->profilingLabel);
 
             if(m_runtime.framework().isDebug()) {
                 logger.debug("executeBegin") << mod->getName();
             }
 
+            Time wallStart = m_cpuTime ? Time::now() : Time::ZERO;
+            Time cpuStart = m_cpuTime ? Time::threadCpuTime() : Time::ZERO;
+            AllocationTracker::Counters allocations;
+            if(m_allocations) {
+                AllocationTracker::attach(&allocations);
+            }
+
             try {
                 mod->cycle();
             } catch(std::exception const& ex) {
@@ -87,13 +118,25 @@ void ExecutionManager::loop() {
                                       << " : " << ex.what();
             }
 
+            if(m_allocations) {
+                AllocationTracker::attach(nullptr);
+                accountAllocations(*wrapper, allocations);
+            }
+            if(m_cpuTime) {
+                accountCpuTime(*wrapper, 0, wallStart, cpuStart);
+            }
+
             if(m_runtime.framework().isDebug()) {
                 logger.debug("executeEnd") << mod->getName();
             }
 
-            profiler().markEnd(m_runtimeName + "." + mod->getName());
+            profiler().markEnd(wrapper->profilingLabel);
 
             m_dog.endModule();
+
+            dataManager.traceModule(*wrapper);
+
+            wrapper->lastCycle = m_cycleCounter;
         }
     }else{
         if(m_runtime.framework().isDebug()) {
@@ -102,6 +145,7 @@ void ExecutionManager::loop() {
 
         // if thread pool is not yet initialized then do it now
         if(threadPool.empty()) {
+            m_messaging.workers(m_numThreads + 1);
             for(int threadNum = 1; threadNum <= m_numThreads; threadNum++) {
                 threadPool.push_back(std::thread([threadNum, this] () {
                     threadFunction(threadNum);
@@ -111,6 +155,7 @@ void ExecutionManager::loop() {
 
         {
             std::lock_guard<std::mutex> lck(mutex);
+            m_cycleStart = Time::now();
             // copy cycleList so it can be modified
             cycleListTmp = cycleList;
             numModulesToExecute = cycleListTmp.countNodes();
@@ -133,10 +178,13 @@ void ExecutionManager::loop() {
             logger.info() << "Cycle end";
         }
     }
+
+    dataManager.afterCycle();
 }
 
 void ExecutionManager::threadFunction(int threadNum) {
     // Thread function
+    Messaging::currentWorker(threadNum);
 
     std::unique_lock<std::mutex> lck(mutex);
 
@@ -173,18 +221,54 @@ void ExecutionManager::threadFunction(int threadNum) {
                               << executableModule->getName();
             }
 
+            std::shared_ptr<ModuleWrapper> wrapper = executableModule->wrapper();
+            Profiler::currentCycle(m_cycleCounter);
+            bool stats = dataManager.channelStats();
+            if(stats) {
+                recordBlocked(*wrapper, Time::now());
+            }
+
             // now we can execute it
             lck.unlock();
-            profiler().markBegin(m_runtimeName + "." + executableModule->getName());
-            try {
-                executableModule->cycle();
-            } catch(std::exception const& ex) {
-                logger.error("cycle") << executableModule->getName() << " throws "
-                                      << extra::typeName(ex) << " : " << ex.what();
+            bool executed = false;
+            if(unchangedInputs(*wrapper)) {
+                if(m_runtime.framework().isDebug()) {
+                    logger.debug("skip") << executableModule->getName();
+                }
+            } else {
+                profiler().markBegin(wrapper->profilingLabel);
+                Time wallStart = m_cpuTime ? Time::now() : Time::ZERO;
+                Time cpuStart = m_cpuTime ? Time::threadCpuTime() : Time::ZERO;
+                AllocationTracker::Counters allocations;
+                if(m_allocations) {
+                    AllocationTracker::attach(&allocations);
+                }
+                try {
+                    executableModule->cycle();
+                } catch(std::exception const& ex) {
+                    logger.error("cycle") << executableModule->getName() << " throws "
+                                          << extra::typeName(ex) << " : " << ex.what();
+                }
+                if(m_allocations) {
+                    AllocationTracker::attach(nullptr);
+                    accountAllocations(*wrapper, allocations);
+                }
+                if(m_cpuTime) {
+                    accountCpuTime(*wrapper, threadNum, wallStart, cpuStart);
+                }
+                profiler().markEnd(wrapper->profilingLabel);
+                dataManager.traceModule(*wrapper);
+                executed = true;
             }
-            profiler().markEnd(m_runtimeName + "." + executableModule->getName());
+            Time end = stats ? Time::now() : Time::ZERO;
             lck.lock();
 
+            // other threads read these in recordBlocked()
+            if(executed) {
+                wrapper->lastCycle = m_cycleCounter;
+                wrapper->lastEnd = end;
+            }
+
             if(m_runtime.framework().isDebug()) {
                 logger.info() << "Thread " << threadNum << " executed "
                               << executableModule->getName();
@@ -354,6 +438,54 @@ void ExecutionManager::validate(){
         if(! success) {
             logger.error("validate") << "Module graph has circle";
         }
+
+        // build the profiling labels once instead of in every cycle
+        for(Module *mod : sortedCycleList) {
+            mod->wrapper()->profilingLabel =
+                profiler().label(m_runtimeName + "." + mod->getName());
+            if(m_allocations) {
+                mod->wrapper()->allocationsLabel =
+                    profiler().label(m_runtimeName + "." + mod->getName() + ".allocations");
+                mod->wrapper()->allocatedBytesLabel =
+                    profiler().label(m_runtimeName + "." + mod->getName() + ".allocated bytes");
+            }
+        }
+    }
+}
+
+bool ExecutionManager::unchangedInputs(ModuleWrapper const& mod) const {
+    if(! mod.skipIfUnchanged || mod.lastCycle < 0 || mod.inputs.empty()) {
+        return false;
+    }
+
+    for(DataChannelInternal const* ch : mod.inputs) {
+        if(ch->getCycle() > mod.lastCycle) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ExecutionManager::recordBlocked(ModuleWrapper const& mod, Time start) {
+    for(DataChannelInternal *ch : mod.inputs) {
+        if(! ch->stats) {
+            continue;
+        }
+
+        // the channel was ready when its last writer in this cycle finished
+        Time ready = m_cycleStart;
+        for(std::shared_ptr<ModuleWrapper> const& writer : ch->writers) {
+            if(writer->lastCycle == m_cycleCounter && writer->lastEnd > ready) {
+                ready = writer->lastEnd;
+            }
+        }
+
+        if(ready > start) {
+            ready = start;
+        }
+
+        ch->stats->addBlocked((ready - m_cycleStart).micros());
     }
 }
 
@@ -377,6 +509,85 @@ bool ExecutionManager::enabledMultithreading() const {
     return m_multithreading;
 }
 
+void ExecutionManager::enableCpuTime(bool flag) {
+    m_cpuTime = flag;
+}
+
+void ExecutionManager::accountCpuTime(ModuleWrapper &mod, int threadNum,
+                                      Time wallStart, Time cpuStart) {
+    Time wall = Time::now() - wallStart;
+    Time cpu = Time::threadCpuTime() - cpuStart;
+
+    mod.wallTime += wall;
+    mod.cpuTime += cpu;
+
+    CpuTime &thread = m_threadCpuTime[threadNum];
+    thread.wall += wall;
+    thread.cpu += cpu;
+}
+
+namespace {
+
+std::string cpuRatio(Time cpu, Time wall) {
+    std::int64_t percent = wall.micros() > 0 ? cpu.micros() * 100 / wall.micros() : 0;
+    return std::to_string(cpu.micros()) + " us cpu / " + std::to_string(wall.micros()) +
+            " us wall (" + std::to_string(percent) + "%)";
+}
+
+}  // namespace
+
+void ExecutionManager::printCpuTime() {
+    if(! m_cpuTime) {
+        return;
+    }
+
+    Time wall = Time::ZERO, cpu = Time::ZERO;
+    for(Module *mod : sortedCycleList) {
+        std::shared_ptr<ModuleWrapper> wrapper = mod->wrapper();
+        logger.info("cpu") << mod->getName() << ": "
+                           << cpuRatio(wrapper->cpuTime, wrapper->wallTime);
+        wall += wrapper->wallTime;
+        cpu += wrapper->cpuTime;
+    }
+
+    for(std::size_t i = 0; i < m_threadCpuTime.size(); i++) {
+        logger.info("cpu") << "thread " << i << ": "
+                           << cpuRatio(m_threadCpuTime[i].cpu, m_threadCpuTime[i].wall);
+    }
+
+    logger.info("cpu") << "total: " << cpuRatio(cpu, wall);
+}
+
+bool ExecutionManager::enableAllocations(bool flag) {
+    m_allocations = flag && AllocationTracker::supported();
+    return m_allocations == flag;
+}
+
+void ExecutionManager::accountAllocations(ModuleWrapper &mod,
+                                          AllocationTracker::Counters const& counters) {
+    mod.allocations += counters;
+    mod.allocationCycles++;
+
+    profiler().counter(mod.allocationsLabel, counters.allocations, Profiler::MODULE);
+    profiler().counter(mod.allocatedBytesLabel, counters.bytes, Profiler::MODULE);
+}
+
+void ExecutionManager::printAllocations() {
+    if(! m_allocations) {
+        return;
+    }
+
+    for(Module *mod : sortedCycleList) {
+        std::shared_ptr<ModuleWrapper> wrapper = mod->wrapper();
+        std::uint64_t cycles = std::max(wrapper->allocationCycles, std::uint64_t(1));
+        logger.info("allocations") << mod->getName() << ": "
+            << wrapper->allocations.allocations / cycles << " allocations, "
+            << wrapper->allocations.bytes / cycles << " bytes, "
+            << wrapper->allocations.frees / cycles << " frees per cycle ("
+            << wrapper->allocationCycles << " cycles)";
+    }
+}
+
 void ExecutionManager::printCycleList(DAG<Module *> &clist) {
     clist.removeTransitiveEdges();
 
@@ -434,16 +645,8 @@ void ExecutionManager::sortModules(){
                     addModuleDependency(mw2,mw1);
                 } else if(prio1 == prio2) {
                     //check if it's reader vs writer
-                    bool mw1Write = false;
-                    bool mw2Write = false;
-
-                    for(std::shared_ptr<ModuleWrapper> r1 : pair.second->writers){
-                        if(r1->name() == mw1->name()){
-                            mw1Write = true;
-                        }else if(r1->name() == mw2->name()){
-                            mw2Write = true;
-                        }
-                    }
+                    bool mw1Write = pair.second->isWriter(mw1);
+                    bool mw2Write = pair.second->isWriter(mw2);
                     if(mw1Write && !mw2Write){
                         addModuleDependency(mw2,mw1);
                     }else if(!mw1Write && mw2Write){
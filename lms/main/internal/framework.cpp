@@ -22,6 +22,11 @@
 #include "lms/internal/runtime.h"
 #include "lms/extra/os.h"
 #include "lms/logging/debug_server_sink.h"
+#include "lms/internal/binary_profiler.h"
+#include "lms/internal/trace_profiler.h"
+#include "lms/internal/histogram_profiler.h"
+#include "lms/internal/sampling_profiler.h"
+#include "lms/endian.h"
 
 namespace lms {
 namespace internal {
@@ -30,8 +35,8 @@ std::string Framework::externalDirectory = LMS_EXTERNAL;
 std::string Framework::configsDirectory = LMS_CONFIGS;
 
 Framework::Framework(const ArgumentHandler &arguments) :
-    logger("lms.Framework"), argumentHandler(arguments),
-    m_running(false) {
+    logger("lms.Framework"), argumentHandler(arguments), m_histograms(nullptr),
+    m_debugServerProfiler(nullptr), m_running(false) {
 
     logging::Context &ctx = logging::Context::getDefault();
 
@@ -46,7 +51,11 @@ Framework::Framework(const ArgumentHandler &arguments) :
     SignalHandler::getInstance()
             .addListener(SIGINT, this)
             .addListener(SIGSEGV, this)
-            .addListener(SIGUSR1, this);
+            .addListener(SIGUSR1, this)
+            .addListener(SIGUSR2, this);
+
+    m_profiler.level(arguments.argProfilingLevel);
+    m_profiler.sampleInterval(arguments.argProfilingSample);
 
     if(arguments.argEnableDebugServer) {
         if(arguments.argDebugServerBind.find('/') == std::string::npos) {
@@ -54,20 +63,82 @@ Framework::Framework(const ArgumentHandler &arguments) :
         } else {
             m_debugServer.useUnix(arguments.argDebugServerBind);
         }
+        m_debugServer.onMessage([this](DebugServer::MessageType type,
+                                       const std::uint8_t *data, std::size_t size) {
+            if(type == DebugServer::MessageType::PROFILING_LEVEL && size >= 1 &&
+                    data[0] <= static_cast<std::uint8_t>(Profiler::Level::FULL)) {
+                if(size >= 5) {
+                    std::uint32_t interval;
+                    std::memcpy(&interval, data + 1, sizeof(interval));
+                    m_profiler.sampleInterval(Endian::betoh(interval));
+                }
+                m_profiler.level(static_cast<Profiler::Level>(data[0]));
+                logger.info() << "Profiling level " << Profiler::levelName(m_profiler.level());
+            }
+        });
         m_debugServer.startThread();
 
         ctx.appendSink(new logging::DebugServerSink(&m_debugServer));
 
-        m_profiler.appendListener(new DebugServerProfiler(&m_debugServer));
+        m_debugServerProfiler = new DebugServerProfiler(&m_debugServer);
+        m_profiler.appendListener(m_debugServerProfiler);
+    }
+
+    // all sinks are installed now
+    if(! arguments.argAsyncLogging.empty()) {
+        logging::Context::OverflowPolicy policy = logging::Context::OverflowPolicy::BLOCK;
+        if(arguments.argAsyncLogging == "drop-newest") {
+            policy = logging::Context::OverflowPolicy::DROP_NEWEST;
+        } else if(arguments.argAsyncLogging == "drop-debug-first") {
+            policy = logging::Context::OverflowPolicy::DROP_DEBUG_FIRST;
+        }
+        ctx.async(true, 4096, policy);
     }
 
     if(! argumentHandler.argProfilingFile.empty()) {
-        logger.info() << "Enable profiling";
-        m_profiler.appendListener(new FileProfiler(arguments.argProfilingFile));
+        logger.info() << "Enable profiling (" << arguments.argProfilingFormat << ")";
+        if(arguments.argProfilingFormat == "binary") {
+            m_profiler.appendListener(new BinaryProfiler(arguments.argProfilingFile));
+        } else if(arguments.argProfilingFormat == "trace") {
+            m_profiler.appendListener(new TraceProfiler(arguments.argProfilingFile));
+        } else {
+            m_profiler.appendListener(new FileProfiler(arguments.argProfilingFile));
+        }
     } else {
         logger.info() << "Disable profiling";
     }
 
+    if(arguments.argHistograms) {
+        m_histograms = new HistogramProfiler();
+
+        if(arguments.argPerfCounters) {
+            PerfCounters counters;
+            if(counters.open()) {
+                logger.info() << "Enable performance counters";
+                m_histograms->perfCounters(true);
+            } else {
+                logger.warn() << "Performance counters are not available: " << counters.error();
+            }
+        }
+
+        if(arguments.argEnableDebugServer) {
+            m_histograms->debugServer(&m_debugServer);
+        }
+        m_profiler.appendListener(m_histograms);
+    }
+
+    if(! arguments.argSamplingFile.empty()) {
+        SamplingProfiler *sampling = new SamplingProfiler(arguments.argSamplingFile,
+                                                          arguments.argSamplingRate);
+        if(sampling->start()) {
+            logger.info() << "Enable sampling (" << arguments.argSamplingRate << " Hz)";
+            m_profiler.appendListener(sampling);
+        } else {
+            logger.warn() << "Sampling is not available on this platform";
+            delete sampling;
+        }
+    }
+
     logger.info() << "RunLevel " <<  arguments.argRunLevel;
 
     std::unique_ptr<logging::ThresholdFilter> filter;
@@ -253,8 +324,23 @@ Framework::Framework(const ArgumentHandler &arguments) :
             }
         }
 
+        // the records since the last cycle end would be lost otherwise
+        if(m_debugServerProfiler != nullptr) {
+            m_debugServerProfiler->flush();
+        }
+
         ctx.filter(nullptr);
         logger.info() << "Stopped";
+
+        for(auto& rt : runtimes) {
+            rt.second->dataManager().printLatencies();
+            rt.second->executionManager().printCpuTime();
+            rt.second->executionManager().printAllocations();
+        }
+
+        if(m_histograms != nullptr) {
+            m_histograms->print(logger);
+        }
     }
 
     exportGraphs();
@@ -274,6 +360,15 @@ Framework::~Framework() {
     SignalHandler::getInstance()
             .removeListener(SIGINT, this)
             .removeListener(SIGSEGV, this);
+
+    // sinks may refer to the debug server
+    logging::Context &ctx = logging::Context::getDefault();
+    if(ctx.async()) {
+        if(ctx.dropped() > 0) {
+            logger.warn() << "Dropped " << ctx.dropped() << " logging events";
+        }
+        ctx.async(false);
+    }
 }
 
 void Framework::signal(int s) {
@@ -306,6 +401,11 @@ void Framework::signal(int s) {
     case SIGUSR1:
         printStacktrace();
         break;
+    case SIGUSR2:
+        // cycle through the levels: off, cycles, sampled, full, off, ...
+        m_profiler.level(static_cast<Profiler::Level>(
+            (static_cast<int>(m_profiler.level()) + 1) % 4));
+        break;
     }
 }
 
@@ -414,6 +514,10 @@ Profiler& Framework::profiler() {
     return m_profiler;
 }
 
+HistogramProfiler* Framework::histograms() {
+    return m_histograms;
+}
+
 Loader<Module>& Framework::moduleLoader() {
     return m_moduleLoader;
 }
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include "lms/internal/histogram_profiler.h"
+#include "lms/internal/debug_server.h"
+#include "lms/endian.h"
+
+namespace lms {
+namespace internal {
+
+HistogramProfiler::HistogramProfiler(Time window, std::size_t windows)
+    : m_window(window), m_server(nullptr),
+      m_perfCounters(false),
+      m_numWindows(std::max(windows, std::size_t(1))), m_current(0),
+      m_windowStart(Time::now()) {}
+
+void HistogramProfiler::debugServer(DebugServer *server) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_server = server;
+}
+
+void HistogramProfiler::perfCounters(bool enable) {
+    m_perfCounters = enable;
+}
+
+void HistogramProfiler::onLabel(Profiler::LabelId id, std::string const& label) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(m_entries.size() <= id) {
+        m_entries.resize(id + 1);
+    }
+    m_entries[id].reset(new Entry);
+    m_entries[id]->label = label;
+    m_entries[id]->windows.resize(m_numWindows);
+    m_entries[id]->counted = 0;
+    m_entries[id]->available = 0;
+    m_ids[label] = id;
+}
+
+void HistogramProfiler::onMarker(Profiler::Type type, Time now, Profiler::LabelId id,
+                                 std::string const& label) {
+    (void)label;
+
+    BeginTimes &beginTimes = m_beginTimes.get([this](BeginTimes &times) {
+        times.micros.clear();
+        times.counters.clear();
+        times.perf.reset();
+
+        if(m_perfCounters) {
+            // fails silently if counters are not allowed on this thread
+            times.perf.reset(new PerfCounters);
+            if(! times.perf->open()) {
+                times.perf.reset();
+            }
+        }
+    });
+    if(beginTimes.micros.size() <= id) {
+        beginTimes.micros.resize(id + 1, -1);
+        beginTimes.counters.resize(id + 1);
+    }
+
+    if(type == Profiler::BEGIN) {
+        beginTimes.micros[id] = now.micros();
+        if(beginTimes.perf) {
+            beginTimes.perf->read(beginTimes.counters[id]);
+        }
+        return;
+    }
+
+    if(type != Profiler::END || beginTimes.micros[id] < 0) {
+        return;
+    }
+
+    PerfCounters::Values delta;
+    if(beginTimes.perf) {
+        beginTimes.perf->read(delta);
+        for(int i = 0; i < PerfCounters::COUNT; i++) {
+            delta.value[i] -= beginTimes.counters[id].value[i];
+        }
+    }
+
+    Time::TimeType duration = now.micros() - beginTimes.micros[id];
+    beginTimes.micros[id] = -1;
+
+    // sent after the lock is released, so that other threads are not
+    // blocked by the debug server
+    std::vector<DebugServer::Datagram> summaries;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    DebugServer *server = m_server;
+    advance(now, server == nullptr ? nullptr : &summaries);
+
+    Entry &entry = *m_entries[id];
+    entry.windows[m_current].record(duration);
+    entry.total.record(duration);
+
+    if(beginTimes.perf) {
+        entry.counters += delta;
+        entry.counted++;
+        for(int i = 0; i < PerfCounters::COUNT; i++) {
+            if(beginTimes.perf->has(static_cast<PerfCounters::Counter>(i))) {
+                entry.available |= 1u << i;
+            }
+        }
+    }
+    lock.unlock();
+
+    for(DebugServer::Datagram const& datagram : summaries) {
+        server->broadcast(datagram);
+    }
+}
+
+void HistogramProfiler::advance(Time now, std::vector<DebugServer::Datagram> *summaries) {
+    if(now - m_windowStart < m_window) {
+        return;
+    }
+
+    if(summaries != nullptr) {
+        summarize(now, *summaries);
+    }
+
+    std::size_t steps = static_cast<std::size_t>((now - m_windowStart).micros() / m_window.micros());
+    for(std::size_t i = 0; i < std::min(steps, m_numWindows); i++) {
+        m_current = (m_current + 1) % m_numWindows;
+        for(auto const& entry : m_entries) {
+            if(entry) {
+                entry->windows[m_current].reset();
+            }
+        }
+    }
+    m_windowStart += Time::fromMicros(m_window.micros() * steps);
+}
+
+void HistogramProfiler::merge(Entry const& entry, extra::LatencyHistogram &hist) const {
+    hist.reset();
+    for(extra::LatencyHistogram const& window : entry.windows) {
+        hist.merge(window);
+    }
+}
+
+void HistogramProfiler::summarize(Time now, std::vector<DebugServer::Datagram> &summaries) {
+    extra::LatencyHistogram hist;
+    for(auto const& entry : m_entries) {
+        if(! entry) {
+            continue;
+        }
+        merge(*entry, hist);
+        if(hist.count() == 0) {
+            continue;
+        }
+
+        std::string const& label = entry->label;
+        std::uint8_t labelLen = std::min(label.size(), size_t(std::numeric_limits<std::uint8_t>::max()));
+        summaries.emplace_back(DebugServer::MessageType::HISTOGRAM, 49 + labelLen);
+        DebugServer::Datagram &datagram = summaries.back();
+
+        uint64_t fields[] = {
+            static_cast<uint64_t>(now.micros()), hist.count(),
+            static_cast<uint64_t>(hist.percentile(0.5)),
+            static_cast<uint64_t>(hist.percentile(0.9)),
+            static_cast<uint64_t>(hist.percentile(0.99)),
+            static_cast<uint64_t>(hist.max())
+        };
+        for(size_t i = 0; i < 6; i++) {
+            *reinterpret_cast<uint64_t*>(&datagram.data()[i * 8]) = Endian::htobe(fields[i]);
+        }
+        datagram.data()[48] = labelLen;
+        std::copy(label.begin(), label.begin() + labelLen, &datagram.data()[49]);
+    }
+}
+
+bool HistogramProfiler::recent(std::string const& label, extra::LatencyHistogram &hist) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_ids.find(label);
+    if(it == m_ids.end()) {
+        return false;
+    }
+
+    merge(*m_entries[it->second], hist);
+    return true;
+}
+
+bool HistogramProfiler::total(std::string const& label, extra::LatencyHistogram &hist) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_ids.find(label);
+    if(it == m_ids.end()) {
+        return false;
+    }
+
+    hist = m_entries[it->second]->total;
+    return true;
+}
+
+bool HistogramProfiler::counters(std::string const& label, PerfCounters::Values &values,
+                                 std::uint64_t &samples) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_ids.find(label);
+    if(it == m_ids.end()) {
+        return false;
+    }
+
+    values = m_entries[it->second]->counters;
+    samples = m_entries[it->second]->counted;
+    return true;
+}
+
+void HistogramProfiler::print(logging::Logger &logger) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for(auto const& entry : m_entries) {
+        if(! entry || entry->total.count() == 0) {
+            continue;
+        }
+
+        extra::LatencyHistogram const& hist = entry->total;
+        logger.info("histogram") << entry->label << ": " << hist.count()
+            << " samples, mean " << static_cast<std::int64_t>(hist.mean()) << " us, p50 "
+            << hist.percentile(0.5) << " us, p90 " << hist.percentile(0.9)
+            << " us, p99 " << hist.percentile(0.99) << " us, max " << hist.max() << " us";
+
+        if(entry->counted > 0) {
+            PerfCounters::Values const& c = entry->counters;
+            std::uint64_t n = entry->counted;
+
+            std::ostringstream stream;
+            stream << entry->label << ": per call";
+            for(int i = 0; i < PerfCounters::COUNT; i++) {
+                if(entry->available & (1u << i)) {
+                    stream << " " << PerfCounters::name(static_cast<PerfCounters::Counter>(i))
+                           << " " << double(c.value[i]) / n;
+                }
+            }
+            if(c.value[PerfCounters::CYCLES] > 0) {
+                stream << " IPC " << double(c.value[PerfCounters::INSTRUCTIONS]) /
+                                     c.value[PerfCounters::CYCLES];
+            }
+            logger.info("histogram") << stream.str();
+        }
+    }
+}
+
+}  // namespace internal
+}  // namespace lms
@@ -24,9 +24,20 @@ std::string ModuleWrapper::getChannelMapping(const std::string &mapFrom) const {
     }
 }
 
+std::string ModuleWrapper::getChannelRuntime(const std::string &name) const {
+    auto it = channelRuntimes.find(name);
+
+    if(it != channelRuntimes.end()) {
+        return it->second;
+    } else {
+        return std::string();
+    }
+}
+
 void ModuleWrapper::update(ModuleWrapper && other) {
     this->channelPriorities = other.channelPriorities;
     this->channelMapping = other.channelMapping;
+    this->channelRuntimes = other.channelRuntimes;
 
     // preserve location of existing ModuleConfigs
     for(auto&& entry : other.configs) {
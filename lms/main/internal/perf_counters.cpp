@@ -0,0 +1,123 @@
+#include <cstring>
+#include <cerrno>
+#include <fstream>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "lms/internal/perf_counters.h"
+
+namespace lms {
+namespace internal {
+
+namespace {
+
+#ifdef __linux__
+int openCounter(std::uint32_t type, std::uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    // required with perf_event_paranoid >= 2
+    attr.exclude_kernel = type == PERF_TYPE_HARDWARE ? 1 : 0;
+    attr.exclude_hv = 1;
+
+    // pid 0 and cpu -1: the calling thread on any cpu
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+#endif
+
+}  // namespace
+
+PerfCounters::PerfCounters() {
+    for(int &fd : m_fds) {
+        fd = -1;
+    }
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for(int fd : m_fds) {
+        if(fd >= 0) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+bool PerfCounters::open() {
+#ifdef __linux__
+    const std::uint32_t types[COUNT] = {
+        PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE
+    };
+    const std::uint64_t configs[COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_SW_CONTEXT_SWITCHES
+    };
+
+    bool any = false;
+    int lastErrno = 0;
+    for(int i = 0; i < COUNT; i++) {
+        if(m_fds[i] < 0) {
+            m_fds[i] = openCounter(types[i], configs[i]);
+            if(m_fds[i] < 0) {
+                lastErrno = errno;
+            }
+        }
+        any = any || m_fds[i] >= 0;
+    }
+
+    if(! any) {
+        m_error = std::strerror(lastErrno);
+
+        std::ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+        int level;
+        if(paranoid >> level) {
+            m_error += " (perf_event_paranoid is " + std::to_string(level) + ")";
+        }
+    }
+    return any;
+#else
+    m_error = "not supported on this platform";
+    return false;
+#endif
+}
+
+bool PerfCounters::has(Counter counter) const {
+    return m_fds[counter] >= 0;
+}
+
+void PerfCounters::read(Values &values) const {
+    for(int i = 0; i < COUNT; i++) {
+        values.value[i] = 0;
+#ifdef __linux__
+        if(m_fds[i] >= 0) {
+            std::uint64_t value;
+            if(::read(m_fds[i], &value, sizeof(value)) == sizeof(value)) {
+                values.value[i] = value;
+            }
+        }
+#endif
+    }
+}
+
+std::string PerfCounters::error() const {
+    return m_error;
+}
+
+const char* PerfCounters::name(Counter counter) {
+    switch(counter) {
+    case CYCLES: return "cycles";
+    case INSTRUCTIONS: return "instructions";
+    case CACHE_MISSES: return "cache misses";
+    case CONTEXT_SWITCHES: return "context switches";
+    default: return "unknown";
+    }
+}
+
+}  // namespace internal
+}  // namespace lms
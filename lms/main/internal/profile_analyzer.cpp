@@ -0,0 +1,446 @@
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <set>
+#include <cstring>
+
+#include "lms/internal/profile_analyzer.h"
+#include "lms/internal/binary_profiler.h"
+
+namespace lms {
+namespace internal {
+
+namespace {
+
+std::string runtimeOf(std::string const& label) {
+    return label.substr(0, label.find('.'));
+}
+
+}  // namespace
+
+ProfileAnalyzer::ProfileAnalyzer() : m_begin(Time::ZERO), m_end(Time::ZERO) {}
+
+bool ProfileAnalyzer::load(std::string const& file) {
+    std::ifstream stream(file, std::ios::binary);
+    if(! stream) {
+        return false;
+    }
+
+    char magic[8] = {};
+    stream.read(magic, sizeof(magic));
+    if(stream && std::memcmp(magic, "LMSPROF", sizeof(magic)) == 0) {
+        BinaryProfileReader reader;
+        if(! reader.open(file)) {
+            return false;
+        }
+
+        BinaryProfileReader::Entry entry;
+        while(reader.next(entry)) {
+            if(entry.type == Profiler::BEGIN || entry.type == Profiler::END) {
+                marker(entry.type, entry.time, entry.label, entry.thread);
+            } else if(entry.type == Profiler::COUNTER) {
+                counter(entry.label, entry.value);
+            }
+        }
+
+        // label ids are consecutive
+        for(std::uint32_t id = 0; ! reader.label(id).empty(); id++) {
+            label(id, reader.label(id));
+        }
+        analyze();
+        return true;
+    }
+
+    stream.clear();
+    stream.seekg(0);
+    return loadCsv(stream);
+}
+
+bool ProfileAnalyzer::loadCsv(std::istream &stream) {
+    // timestamps are deltas to the previous marker
+    Time time = Time::ZERO;
+    std::string line;
+
+    while(std::getline(stream, line)) {
+        if(line.empty()) {
+            continue;
+        }
+
+        std::size_t first = line.find(',');
+        std::size_t second = line.find(',', first + 1);
+        if(first == std::string::npos || second == std::string::npos) {
+            return false;
+        }
+
+        int type = std::atoi(line.substr(0, first).c_str());
+        std::uint32_t id = static_cast<std::uint32_t>(
+            std::strtoul(line.substr(first + 1, second - first - 1).c_str(), nullptr, 10));
+
+        if(type == Profiler::MAPPING) {
+            label(id, line.substr(second + 1));
+        } else if(type == Profiler::BEGIN || type == Profiler::END) {
+            time += Time::fromMicros(std::strtoll(line.substr(second + 1).c_str(), nullptr, 10));
+            marker(static_cast<Profiler::Type>(type), time, id, 0);
+        } else if(type == Profiler::COUNTER) {
+            counter(id, std::strtoll(line.substr(second + 1).c_str(), nullptr, 10));
+        }
+    }
+
+    analyze();
+    return true;
+}
+
+void ProfileAnalyzer::label(std::uint32_t id, std::string const& name) {
+    if(m_labels.size() <= id) {
+        m_labels.resize(id + 1);
+    }
+    m_labels[id] = name;
+}
+
+void ProfileAnalyzer::marker(Profiler::Type type, Time time, std::uint32_t label,
+                             std::uint32_t thread) {
+    m_markers.push_back(Marker{type, time, label, thread});
+}
+
+void ProfileAnalyzer::counter(std::uint32_t label, std::int64_t value) {
+    m_counterValues.push_back(std::make_pair(label, value));
+}
+
+std::string ProfileAnalyzer::labelName(std::uint32_t id) const {
+    if(id < m_labels.size() && ! m_labels[id].empty()) {
+        return m_labels[id];
+    }
+    return "#" + std::to_string(id);
+}
+
+void ProfileAnalyzer::analyze() {
+    m_intervals.clear();
+    m_cycles.clear();
+    m_runtimeCycles.clear();
+    m_cycleModules.clear();
+    m_stats.clear();
+    m_counters.clear();
+    m_threads.clear();
+
+    for(auto const& value : m_counterValues) {
+        std::string name = labelName(value.first);
+        auto it = m_counters.find(name);
+        if(it == m_counters.end()) {
+            m_counters[name] = CounterStats{name, 1, value.second, value.second, value.second};
+            continue;
+        }
+
+        CounterStats &stats = it->second;
+        stats.count++;
+        stats.sum += value.second;
+        stats.min = std::min(stats.min, value.second);
+        stats.max = std::max(stats.max, value.second);
+    }
+
+    if(m_markers.empty()) {
+        return;
+    }
+
+    // pair begin and end markers per thread and label
+    std::map<std::pair<std::uint32_t, std::uint32_t>, Time> open;
+    m_begin = m_end = m_markers.front().time;
+
+    for(Marker const& marker : m_markers) {
+        m_begin = std::min(m_begin, marker.time);
+        m_end = std::max(m_end, marker.time);
+
+        auto key = std::make_pair(marker.thread, marker.label);
+        if(marker.type == Profiler::BEGIN) {
+            open[key] = marker.time;
+        } else {
+            auto it = open.find(key);
+            if(it != open.end()) {
+                m_intervals.push_back(Interval{marker.label, marker.thread, it->second, marker.time});
+                open.erase(it);
+            }
+        }
+    }
+
+    std::stable_sort(m_intervals.begin(), m_intervals.end(),
+                     [](Interval const& a, Interval const& b) { return a.begin < b.begin; });
+
+    // runtimes are the prefixes of all module labels
+    std::set<std::string> runtimes;
+    for(std::string const& name : m_labels) {
+        if(name.find('.') != std::string::npos) {
+            runtimes.insert(runtimeOf(name));
+        }
+    }
+
+    for(Interval const& interval : m_intervals) {
+        std::string name = labelName(interval.label);
+        if(runtimes.count(name) > 0) {
+            m_runtimeCycles[name].push_back(m_cycles.size());
+            m_cycles.push_back(interval);
+        }
+    }
+
+    m_cycleModules.resize(m_cycles.size());
+    std::map<std::uint32_t, std::size_t> threadIndex;
+    std::vector<std::pair<std::int64_t, Time>> lastModule;
+
+    for(std::size_t i = 0; i < m_intervals.size(); i++) {
+        Interval const& interval = m_intervals[i];
+        std::string name = labelName(interval.label);
+
+        LabelStats &stats = m_stats[name];
+        if(stats.label.empty()) {
+            stats.label = name;
+            stats.total = Time::ZERO;
+            stats.critical = 0;
+            stats.criticalTime = Time::ZERO;
+        }
+        stats.hist.record(interval.duration().micros());
+        stats.total += interval.duration();
+
+        if(name.find('.') == std::string::npos) {
+            continue;
+        }
+
+        std::int64_t cycle = cycleOf(interval);
+        if(cycle >= 0) {
+            m_cycleModules[cycle].push_back(i);
+        }
+
+        auto it = threadIndex.find(interval.thread);
+        if(it == threadIndex.end()) {
+            it = threadIndex.emplace(interval.thread, m_threads.size()).first;
+            m_threads.push_back(ThreadStats{interval.thread, Time::ZERO, 0, Time::ZERO, Time::ZERO});
+            lastModule.push_back(std::make_pair(-1, interval.begin));
+        }
+
+        ThreadStats &thread = m_threads[it->second];
+        std::int64_t &lastCycle = lastModule[it->second].first;
+        Time &lastEnd = lastModule[it->second].second;
+
+        // nested markers are only counted once
+        if(interval.end > lastEnd) {
+            thread.busy += interval.end - std::max(interval.begin, lastEnd);
+        }
+        if(cycle >= 0 && cycle == lastCycle && interval.begin > lastEnd) {
+            Time gap = interval.begin - lastEnd;
+            thread.gaps++;
+            thread.idle += gap;
+            thread.maxGap = std::max(thread.maxGap, gap);
+        }
+        lastCycle = cycle;
+        lastEnd = std::max(lastEnd, interval.end);
+    }
+
+    for(std::size_t cycle = 0; cycle < m_cycles.size(); cycle++) {
+        for(Interval const& interval : criticalPath(cycle)) {
+            LabelStats &stats = m_stats[labelName(interval.label)];
+            stats.critical++;
+            stats.criticalTime += interval.duration();
+        }
+    }
+
+    std::sort(m_threads.begin(), m_threads.end(),
+              [](ThreadStats const& a, ThreadStats const& b) { return a.thread < b.thread; });
+}
+
+std::int64_t ProfileAnalyzer::cycleOf(Interval const& interval) const {
+    auto runtime = m_runtimeCycles.find(runtimeOf(labelName(interval.label)));
+    if(runtime == m_runtimeCycles.end()) {
+        return -1;
+    }
+
+    std::vector<std::size_t> const& cycles = runtime->second;
+    auto it = std::upper_bound(cycles.begin(), cycles.end(), interval.begin,
+                               [this](Time const& time, std::size_t cycle) {
+        return time < m_cycles[cycle].begin;
+    });
+    if(it == cycles.begin()) {
+        return -1;
+    }
+    --it;
+    return interval.begin <= m_cycles[*it].end ? static_cast<std::int64_t>(*it) : -1;
+}
+
+std::vector<ProfileAnalyzer::Interval> const& ProfileAnalyzer::intervals() const {
+    return m_intervals;
+}
+
+std::vector<ProfileAnalyzer::Interval> const& ProfileAnalyzer::cycles() const {
+    return m_cycles;
+}
+
+std::map<std::string, ProfileAnalyzer::LabelStats> const& ProfileAnalyzer::labels() const {
+    return m_stats;
+}
+
+std::map<std::string, ProfileAnalyzer::CounterStats> const& ProfileAnalyzer::counters() const {
+    return m_counters;
+}
+
+std::vector<ProfileAnalyzer::ThreadStats> const& ProfileAnalyzer::threads() const {
+    return m_threads;
+}
+
+Time ProfileAnalyzer::span() const {
+    return m_end - m_begin;
+}
+
+std::vector<ProfileAnalyzer::Interval> ProfileAnalyzer::criticalPath(std::size_t cycle) const {
+    std::vector<Interval> path;
+    if(cycle >= m_cycles.size()) {
+        return path;
+    }
+
+    std::vector<std::size_t> modules = m_cycleModules[cycle];
+    Time point = m_cycles[cycle].end;
+
+    while(true) {
+        auto best = modules.end();
+        for(auto it = modules.begin(); it != modules.end(); ++it) {
+            Interval const& interval = m_intervals[*it];
+            if(interval.end <= point && (best == modules.end() ||
+                                         m_intervals[*best].end < interval.end)) {
+                best = it;
+            }
+        }
+        if(best == modules.end()) {
+            break;
+        }
+
+        path.push_back(m_intervals[*best]);
+        point = m_intervals[*best].begin;
+        modules.erase(best);
+    }
+
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+void ProfileAnalyzer::print(std::ostream &os) const {
+    os << "Profile of " << span().toFloat<std::milli, double>() << " ms, "
+       << m_cycles.size() << " cycles, " << m_threads.size() << " threads\n\n";
+
+    os << std::left << std::setw(32) << "label" << std::right
+       << std::setw(8) << "count" << std::setw(10) << "mean us" << std::setw(10) << "p50 us"
+       << std::setw(10) << "p99 us" << std::setw(10) << "max us" << std::setw(12) << "total ms"
+       << std::setw(10) << "critical" << "\n";
+
+    for(auto const& entry : m_stats) {
+        LabelStats const& stats = entry.second;
+        os << std::left << std::setw(32) << stats.label << std::right
+           << std::setw(8) << stats.hist.count()
+           << std::setw(10) << static_cast<std::int64_t>(stats.hist.mean())
+           << std::setw(10) << stats.hist.percentile(0.5)
+           << std::setw(10) << stats.hist.percentile(0.99)
+           << std::setw(10) << stats.hist.max()
+           << std::setw(12) << stats.total.micros() / 1000;
+
+        // share of the runtime's cycles the module was on the critical path
+        auto runtime = m_runtimeCycles.find(runtimeOf(stats.label));
+        if(stats.label.find('.') != std::string::npos && runtime != m_runtimeCycles.end()) {
+            os << std::setw(9) << 100 * stats.critical / runtime->second.size() << "%";
+        }
+        os << "\n";
+    }
+
+    os << "\n" << std::left << std::setw(32) << "runtime" << std::right
+       << std::setw(8) << "cycles" << std::setw(16) << "mean cycle us"
+       << std::setw(18) << "mean critical us" << "\n";
+    for(auto const& runtime : m_runtimeCycles) {
+        Time cycles = Time::ZERO;
+        Time critical = Time::ZERO;
+        for(std::size_t cycle : runtime.second) {
+            cycles += m_cycles[cycle].duration();
+            for(Interval const& interval : criticalPath(cycle)) {
+                critical += interval.duration();
+            }
+        }
+        int count = static_cast<int>(runtime.second.size());
+        os << std::left << std::setw(32) << runtime.first << std::right
+           << std::setw(8) << count << std::setw(16) << (cycles / count).micros()
+           << std::setw(18) << (critical / count).micros() << "\n";
+    }
+
+    os << "\n" << std::left << std::setw(8) << "thread" << std::right
+       << std::setw(12) << "busy us" << std::setw(8) << "util" << std::setw(8) << "gaps"
+       << std::setw(12) << "idle us" << std::setw(12) << "max gap us" << "\n";
+    for(ThreadStats const& thread : m_threads) {
+        std::int64_t util = span().micros() > 0 ? 100 * thread.busy.micros() / span().micros() : 0;
+        os << std::left << std::setw(8) << thread.thread << std::right
+           << std::setw(12) << thread.busy.micros()
+           << std::setw(7) << util << "%"
+           << std::setw(8) << thread.gaps
+           << std::setw(12) << thread.idle.micros()
+           << std::setw(12) << thread.maxGap.micros() << "\n";
+    }
+
+    if(m_counters.empty()) {
+        return;
+    }
+
+    os << "\n" << std::left << std::setw(32) << "counter" << std::right
+       << std::setw(8) << "count" << std::setw(12) << "mean" << std::setw(12) << "min"
+       << std::setw(12) << "max" << std::setw(14) << "total" << "\n";
+    for(auto const& entry : m_counters) {
+        CounterStats const& stats = entry.second;
+        os << std::left << std::setw(32) << stats.label << std::right
+           << std::setw(8) << stats.count
+           << std::setw(12) << stats.sum / static_cast<std::int64_t>(stats.count)
+           << std::setw(12) << stats.min
+           << std::setw(12) << stats.max
+           << std::setw(14) << stats.sum << "\n";
+    }
+}
+
+int ProfileAnalyzer::compare(ProfileAnalyzer const& base, ProfileAnalyzer const& other,
+                             double threshold, std::ostream &os) {
+    int regressions = 0;
+
+    os << std::left << std::setw(32) << "label" << std::right
+       << std::setw(12) << "base mean" << std::setw(12) << "mean" << std::setw(9) << "change"
+       << std::setw(12) << "base p99" << std::setw(12) << "p99" << "\n";
+
+    for(auto const& entry : base.m_stats) {
+        auto it = other.m_stats.find(entry.first);
+        if(it == other.m_stats.end()) {
+            os << std::left << std::setw(32) << entry.first << " only in base\n";
+            continue;
+        }
+
+        extra::LatencyHistogram const& before = entry.second.hist;
+        extra::LatencyHistogram const& after = it->second.hist;
+        double change = before.mean() > 0 ? after.mean() / before.mean() - 1 : 0;
+
+        std::ostringstream percent;
+        percent << std::showpos << static_cast<int>(change * 100) << "%";
+
+        os << std::left << std::setw(32) << entry.first << std::right
+           << std::setw(12) << static_cast<std::int64_t>(before.mean())
+           << std::setw(12) << static_cast<std::int64_t>(after.mean())
+           << std::setw(9) << percent.str()
+           << std::setw(12) << before.percentile(0.99)
+           << std::setw(12) << after.percentile(0.99);
+
+        // ignore sub-microsecond noise
+        if(change > threshold && after.mean() - before.mean() >= 1) {
+            os << "  REGRESSION";
+            regressions++;
+        } else if(change < -threshold) {
+            os << "  improved";
+        }
+        os << "\n";
+    }
+
+    for(auto const& entry : other.m_stats) {
+        if(base.m_stats.count(entry.first) == 0) {
+            os << std::left << std::setw(32) << entry.first << " only in this profile\n";
+        }
+    }
+
+    return regressions;
+}
+
+}  // namespace internal
+}  // namespace lms
@@ -7,26 +7,203 @@
 namespace lms {
 namespace internal {
 
-Profiler::Profiler() {}
+namespace {
+
+/* cycle of the calling thread, set by the execution manager */
+thread_local int currentCycleNumber = -1;
+
+}  // namespace
+
+constexpr Profiler::LabelId Profiler::MAX_LABELS;
+constexpr Profiler::LabelId Profiler::LABEL_BLOCK;
+constexpr std::uint8_t Profiler::SAMPLED_MASK;
+
+Profiler::Profiler() : m_mask(0), m_appliedInterval(10), m_level(Level::FULL),
+    m_sampleInterval(10) {
+    for(auto &block : m_labelBlocks) {
+        block.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+Profiler::~Profiler() {
+    for(auto &block : m_labelBlocks) {
+        delete[] block.load(std::memory_order_relaxed);
+    }
+}
+
+Profiler::LabelId Profiler::label(const std::string &name) {
+    std::lock_guard<std::mutex> lock(m_labelsMutex);
+
+    auto it = m_labelIds.find(name);
+    if(it != m_labelIds.end()) {
+        return it->second;
+    }
+
+    if(m_labelIds.size() >= MAX_LABELS - 1) {
+        // the last id collects all labels that do not fit
+        LabelId id = MAX_LABELS - 1;
+        if(m_labelIds.size() == MAX_LABELS - 1) {
+            m_labelBlocks[id / LABEL_BLOCK].load()[id % LABEL_BLOCK] = "<other>";
+            m_labelIds["<other>"] = id;
+            for(auto & listener : m_listeners) {
+                listener->onLabel(id, labelName(id));
+            }
+        }
+        return id;
+    }
+
+    LabelId id = static_cast<LabelId>(m_labelIds.size());
+    std::atomic<std::string*> &block = m_labelBlocks[id / LABEL_BLOCK];
+    if(block.load(std::memory_order_relaxed) == nullptr) {
+        block.store(new std::string[LABEL_BLOCK], std::memory_order_release);
+    }
+    block.load(std::memory_order_relaxed)[id % LABEL_BLOCK] = name;
+    m_labelIds[name] = id;
+
+    for(auto & listener : m_listeners) {
+        listener->onLabel(id, name);
+    }
+    return id;
+}
+
+const std::string& Profiler::labelName(LabelId id) const {
+    return m_labelBlocks[id / LABEL_BLOCK].load(std::memory_order_acquire)[id % LABEL_BLOCK];
+}
+
+void Profiler::currentCycle(int cycle) {
+    currentCycleNumber = cycle;
+}
+
+int Profiler::currentCycle() {
+    return currentCycleNumber;
+}
+
+void Profiler::level(Level level) {
+    m_level.store(level);
+}
+
+Profiler::Level Profiler::level() const {
+    return m_level.load();
+}
+
+void Profiler::sampleInterval(std::uint32_t n) {
+    m_sampleInterval.store(std::max(n, std::uint32_t(1)));
+}
+
+std::uint32_t Profiler::sampleInterval() const {
+    return m_sampleInterval.load();
+}
+
+bool Profiler::levelFromName(const std::string &name, Level &level) {
+    if(name == "off") level = Level::OFF;
+    else if(name == "cycles") level = Level::CYCLES;
+    else if(name == "sampled") level = Level::SAMPLED;
+    else if(name == "full") level = Level::FULL;
+    else return false;
+
+    return true;
+}
+
+std::string Profiler::levelName(Level level) {
+    switch(level) {
+    case Level::OFF: return "off";
+    case Level::CYCLES: return "cycles";
+    case Level::SAMPLED: return "sampled";
+    case Level::FULL: return "full";
+    }
+    return "?";
+}
+
+void Profiler::applyLevel() {
+    std::uint8_t mask = 0;
+    if(! m_listeners.empty()) {
+        switch(m_level.load()) {
+        case Level::OFF: mask = 0; break;
+        case Level::CYCLES: mask = CYCLE; break;
+        case Level::SAMPLED: mask = CYCLE | MODULE | SAMPLED_MASK; break;
+        case Level::FULL: mask = CYCLE | MODULE; break;
+        }
+    }
+    m_appliedInterval.store(m_sampleInterval.load());
+    m_mask.store(mask);
+}
+
+bool Profiler::sampledCycle() const {
+    if((m_mask.load(std::memory_order_relaxed) & SAMPLED_MASK) == 0) {
+        return true;
+    }
+
+    // markers outside of cycles are always reported
+    int cycle = currentCycleNumber;
+    return cycle < 0 || cycle % m_appliedInterval.load(std::memory_order_relaxed) == 0;
+}
 
 void Profiler::markBegin(const std::string &label) {
-    mark(BEGIN, label);
+    if(m_mask.load(std::memory_order_relaxed) & MODULE) {
+        mark(BEGIN, this->label(label));
+    }
 }
 
 void Profiler::markEnd(const std::string &label) {
-    mark(END, label);
+    if(m_mask.load(std::memory_order_relaxed) & MODULE) {
+        mark(END, this->label(label));
+    }
+}
+
+void Profiler::channelStats(const std::string &label, ChannelStats::Values const& values) {
+    if((m_mask.load(std::memory_order_relaxed) & MODULE) != 0) {
+        channelStats(this->label(label), values);
+    }
+}
+
+void Profiler::channelStats(LabelId id, ChannelStats::Values const& values) {
+    if((m_mask.load(std::memory_order_relaxed) & MODULE) == 0 || ! sampledCycle()) {
+        return;
+    }
+
+    lms::Time now = lms::Time::now();
+
+    for(auto & listener : m_listeners) {
+        listener->onChannelStats(now, id, labelName(id), values);
+    }
 }
 
-void Profiler::mark(Type type, const std::string &label) {
+void Profiler::mark(Type type, LabelId label) {
+    if(! sampledCycle()) {
+        return;
+    }
+
     lms::Time now = lms::Time::now();
+    const std::string &name = labelName(label);
 
     for(auto & listener : m_listeners) {
-        listener->onMarker(type, now, label);
+        listener->onMarker(type, now, label, name);
+    }
+}
+
+void Profiler::reportCounter(LabelId label, std::int64_t value) {
+    if(! sampledCycle()) {
+        return;
+    }
+
+    lms::Time now = lms::Time::now();
+    const std::string &name = labelName(label);
+
+    for(auto & listener : m_listeners) {
+        listener->onCounter(now, label, name, value);
     }
 }
 
 void Profiler::appendListener(ProfilingListener *listener) {
+    std::lock_guard<std::mutex> lock(m_labelsMutex);
+
+    // the listener has missed all labels registered so far
+    for(LabelId id = 0; id < m_labelIds.size(); id++) {
+        listener->onLabel(id, labelName(id));
+    }
+
     m_listeners.push_back(std::unique_ptr<ProfilingListener>(listener));
+    applyLevel();
 }
 
 FileProfiler::FileProfiler(std::string const& file)
@@ -40,49 +217,132 @@ FileProfiler::~FileProfiler() {
     }
 }
 
-void FileProfiler::onMarker(Profiler::Type type, Time now, std::string const& label) {
-    // lock after checking enabled flag and saving the current time
+void FileProfiler::onLabel(Profiler::LabelId id, std::string const& label) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    // write string mapping to file (for later parsing)
+    m_stream << static_cast<int>(Profiler::MAPPING) << "," << id << ","
+        << label << "\n";
+}
+
+void FileProfiler::onMarker(Profiler::Type type, Time now, Profiler::LabelId id,
+                            std::string const& label) {
+    (void)label;
+    // lock after saving the current time
     std::unique_lock<std::mutex> lock(m_mutex);
 
     Time diff = now - m_lastTimestamp;
     m_lastTimestamp = now;
 
-    MappingType::iterator it = m_stringMapping.find(label);
-    size_t id;
+    m_stream << static_cast<int>(type) << "," << id << "," <<
+        diff.micros() << "\n";
+}
+
+void FileProfiler::onChannelStats(Time now, Profiler::LabelId id, std::string const& label,
+                                  ChannelStats::Values const& values) {
+    (void)now;
+    (void)label;
+    std::unique_lock<std::mutex> lock(m_mutex);
 
-    if(it == m_stringMapping.end()) {
-        // id is an ascending value starting with 0
-        id = m_stringMapping.size();
-        // insert new string mapping
-        m_stringMapping[label] = id;
+    m_stream << static_cast<int>(Profiler::CHANNEL_STATS) << "," << id << ","
+        << values.reads << "," << values.writes << "," << values.bytes << ","
+        << values.blockedMicros << "\n";
+}
 
-        // write string mapping to file (for later parsing)
-        m_stream << static_cast<int>(Profiler::MAPPING) << "," << id << ","
-            << label << "\n";
-    } else {
-        // otherwise just take the stored id
-        id = it->second;
-    }
+void FileProfiler::onCounter(Time now, Profiler::LabelId id, std::string const& label,
+                             std::int64_t value) {
+    (void)now;
+    (void)label;
+    std::unique_lock<std::mutex> lock(m_mutex);
 
-    m_stream << static_cast<int>(type) << "," << id << "," <<
-        diff.micros() << "\n";
+    m_stream << static_cast<int>(Profiler::COUNTER) << "," << id << "," << value << "\n";
 }
 
+constexpr std::size_t DebugServerProfiler::MAX_BATCH;
+
 DebugServerProfiler::DebugServerProfiler(DebugServer *server) :
-    m_server(server) {}
+    m_server(server), m_connections(0),
+    m_numThreads(0) {}
 
-void DebugServerProfiler::onMarker(Profiler::Type type, Time now, std::string const& label) {
-    std::uint8_t labelLen = std::min(label.size(), size_t(std::numeric_limits<std::uint8_t>::max()));
+void DebugServerProfiler::onLabel(Profiler::LabelId id, std::string const& label) {
+    std::lock_guard<std::mutex> lock(m_mutex);
 
-    internal::DebugServer::Datagram datagram(DebugServer::MessageType::PROFILING, 10 + labelLen);
+    if(m_labels.size() <= id) {
+        m_labels.resize(id + 1);
+    }
+    m_labels[id] = label;
+    m_batch.mapping(id, label);
+    if(m_batch.size() >= MAX_BATCH) {
+        send();
+    }
+}
+
+void DebugServerProfiler::onMarker(Profiler::Type type, Time now, Profiler::LabelId id,
+                                   std::string const& label) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::uint16_t thread = m_thread.get([this](std::uint16_t &thread) {
+        thread = m_numThreads++;
+    });
 
-    datagram.data()[0] = static_cast<std::uint8_t>(type);
-    *reinterpret_cast<uint64_t*>(&datagram.data()[1]) = Endian::htobe(static_cast<uint64_t>(now.micros()));
-    datagram.data()[9] = labelLen;
+    m_batch.marker(static_cast<TelemetryEncoder::Kind>(type), now, id, thread,
+                   Profiler::currentCycle());
+
+    // runtime cycles are the only labels without a dot
+    bool cycleEnd = type == Profiler::END && label.find('.') == std::string::npos;
+    if(cycleEnd || m_batch.size() >= MAX_BATCH) {
+        send();
+    }
+}
 
-    std::copy(label.begin(), label.begin() + labelLen, &datagram.data()[10]);
+void DebugServerProfiler::onChannelStats(Time now, Profiler::LabelId id,
+                                         std::string const& label,
+                                         ChannelStats::Values const& values) {
+    (void)label;
+    std::lock_guard<std::mutex> lock(m_mutex);
 
-    m_server->broadcast(datagram);
+    m_batch.channelStats(now, id, values);
+    if(m_batch.size() >= MAX_BATCH) {
+        send();
+    }
+}
+
+void DebugServerProfiler::onCounter(Time now, Profiler::LabelId id, std::string const& label,
+                                    std::int64_t value) {
+    (void)label;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_batch.counter(now, id, value);
+    if(m_batch.size() >= MAX_BATCH) {
+        send();
+    }
+}
+
+void DebugServerProfiler::flush() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    send();
+}
+
+void DebugServerProfiler::send() {
+    std::uint64_t connections = m_server->connections();
+    if(connections != m_connections) {
+        // new clients have missed the mappings
+        m_connections = connections;
+
+        TelemetryEncoder mappings;
+        for(Profiler::LabelId id = 0; id < m_labels.size(); id++) {
+            mappings.mapping(id, m_labels[id]);
+            if(mappings.size() >= MAX_BATCH) {
+                m_server->broadcast(mappings.finish());
+            }
+        }
+        if(mappings.records() > 0) {
+            m_server->broadcast(mappings.finish());
+        }
+    }
+
+    if(m_batch.records() > 0) {
+        m_server->broadcast(m_batch.finish());
+    }
 }
 
 }  // namespace internal
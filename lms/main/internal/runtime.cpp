@@ -10,11 +10,19 @@ Runtime::Runtime(const std::string &name, Framework& framework) :
     m_name(name), logger(name), m_framework(framework),
     m_argumentHandler(framework.getArgumentHandler()),
     m_profiler(framework.profiler()),
+    m_profilingLabel(m_profiler.label(name)),
+    m_cycleTimeLabel(m_profiler.label(name + ".cycle time (us)")),
+    m_overflowLabel(m_profiler.label(name + ".overflow (us)")),
     m_executionManager(m_profiler, *this),
     m_executionType(ExecutionType::NEVER_MAIN_THREAD),
     m_state(State::RUNNING), m_threadRunning(false), m_requestReset(false) {
 
     m_executionManager.enabledMultithreading(m_argumentHandler.argMultithreaded);
+    m_executionManager.getDataManager().enableChannelStats(m_argumentHandler.argChannelStats);
+    m_executionManager.enableCpuTime(m_argumentHandler.argCpuTime);
+    if(! m_executionManager.enableAllocations(m_argumentHandler.argAllocations)) {
+        logger.warn() << "Allocations cannot be counted, build with LMS_ALLOCATION_TRACKING";
+    }
 
     if(m_argumentHandler.argMultithreaded) {
         if(m_argumentHandler.argThreadsAuto) {
@@ -141,9 +149,16 @@ bool Runtime::cycle() {
     }
 
     m_clock.beforeLoopIteration();
-    m_profiler.markBegin(m_name);
+    // level changes must not split the markers of a cycle
+    m_profiler.applyLevel();
+    if(m_profiler.enabled() && m_executionManager.cycleCounter() >= 0) {
+        m_profiler.counter(m_cycleTimeLabel, m_clock.lastWorkTime().micros());
+        m_profiler.counter(m_overflowLabel, m_clock.lastOverflow().micros());
+    }
+    Profiler::currentCycle(m_executionManager.cycleCounter() + 1);
+    m_profiler.markBegin(m_profilingLabel, Profiler::CYCLE);
     m_executionManager.loop();
-    m_profiler.markEnd(m_name);
+    m_profiler.markEnd(m_profilingLabel, Profiler::CYCLE);
 
     // Config monitor
     m_executionManager.updateOrInstall();
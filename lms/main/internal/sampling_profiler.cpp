@@ -0,0 +1,216 @@
+#include <fstream>
+#include <unordered_map>
+#include <chrono>
+#include <algorithm>
+
+#include "lms/internal/sampling_profiler.h"
+#include "lms/internal/backtrace_formatter.h"
+
+namespace lms {
+namespace internal {
+
+namespace {
+
+/* frames of the signal handler itself */
+const int SKIP_FRAMES = 2;
+
+const int MAX_DEPTH = 8;
+
+/* labels begun and not yet ended on the calling thread, read by the signal
+ * handler, so the TLS block must not be allocated lazily */
+#if defined(__GNUC__)
+__attribute__((tls_model("initial-exec")))
+#endif
+thread_local std::int32_t labelStack[MAX_DEPTH];
+
+#if defined(__GNUC__)
+__attribute__((tls_model("initial-exec")))
+#endif
+thread_local std::int32_t labelDepth = 0;
+
+}  // namespace
+
+constexpr int SamplingProfiler::MAX_FRAMES;
+constexpr std::size_t SamplingProfiler::QUEUE_CAPACITY;
+
+std::atomic<SamplingProfiler*> SamplingProfiler::s_active(nullptr);
+std::atomic<int> SamplingProfiler::s_inHandler(0);
+
+SamplingProfiler::SamplingProfiler(std::string const& file, int frequency)
+    : m_file(file), m_frequency(frequency), m_started(false),
+      m_queue(QUEUE_CAPACITY), m_dropped(0), m_samples(0), m_running(false) {}
+
+SamplingProfiler::~SamplingProfiler() {
+    stop();
+
+    if(! m_file.empty()) {
+        std::ofstream stream(m_file);
+        writeFolded(stream);
+    }
+}
+
+bool SamplingProfiler::start() {
+    SamplingProfiler *expected = nullptr;
+    if(! s_active.compare_exchange_strong(expected, this)) {
+        return false;
+    }
+
+    // the first backtrace may load libraries, not in the signal handler
+    void *frames[MAX_FRAMES];
+    captureStacktrace(frames, MAX_FRAMES);
+
+    m_running = true;
+    m_thread = std::thread([this]() {
+        drainLoop();
+    });
+
+    if(! startTimer()) {
+        stop();
+        return false;
+    }
+
+    m_started = true;
+    return true;
+}
+
+void SamplingProfiler::stop() {
+    if(s_active.load() != this) {
+        return;
+    }
+
+    if(m_started) {
+        stopTimer();
+        m_started = false;
+    }
+    s_active.store(nullptr);
+
+    // a handler that loaded this profiler before may still push samples
+    while(s_inHandler.load() != 0) {
+        std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+
+    drain();
+}
+
+void SamplingProfiler::onLabel(Profiler::LabelId id, std::string const& label) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(m_labels.size() <= id) {
+        m_labels.resize(id + 1);
+    }
+    m_labels[id] = label;
+}
+
+void SamplingProfiler::onMarker(Profiler::Type type, Time now, Profiler::LabelId id,
+                                std::string const& label) {
+    (void)now;
+    (void)label;
+
+    if(type == Profiler::BEGIN) {
+        if(labelDepth < MAX_DEPTH) {
+            labelStack[labelDepth] = static_cast<std::int32_t>(id);
+        }
+        labelDepth++;
+    } else if(type == Profiler::END && labelDepth > 0) {
+        labelDepth--;
+    }
+}
+
+void SamplingProfiler::sample() {
+    Sample sample;
+
+    int depth = labelDepth;
+    sample.label = depth > 0 ? labelStack[std::min(depth, MAX_DEPTH) - 1] : -1;
+    sample.depth = captureStacktrace(sample.frames, MAX_FRAMES);
+
+    if(! m_queue.push(sample)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t SamplingProfiler::samples() {
+    drain();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_samples;
+}
+
+std::uint64_t SamplingProfiler::dropped() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+void SamplingProfiler::drainLoop() {
+    blockSignal();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(m_running) {
+        m_cv.wait_for(lock, std::chrono::milliseconds(20));
+
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+void SamplingProfiler::drain() {
+    Sample sample;
+    std::vector<void*> frames;
+
+    while(m_queue.pop(sample)) {
+        frames.clear();
+        for(int i = std::min(sample.depth, MAX_FRAMES) - 1; i >= SKIP_FRAMES; i--) {
+            frames.push_back(sample.frames[i]);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stacks[std::make_pair(sample.label, frames)]++;
+        m_samples++;
+    }
+}
+
+void SamplingProfiler::writeFolded(std::ostream &os) {
+    drain();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unordered_map<void*, std::string> names;
+
+    for(auto const& stack : m_stacks) {
+        std::int32_t label = stack.first.first;
+        if(label >= 0 && static_cast<std::size_t>(label) < m_labels.size()) {
+            // "runtime.module" becomes two frames
+            std::string name = m_labels[label];
+            std::size_t dot = name.find('.');
+            if(dot != std::string::npos) {
+                name[dot] = ';';
+            }
+            os << name;
+        } else {
+            os << "[no module]";
+        }
+
+        for(void *frame : stack.first.second) {
+            auto it = names.find(frame);
+            if(it == names.end()) {
+                it = names.emplace(frame, frameName(frame)).first;
+                // ';' separates frames, ' ' the count
+                for(char &c : it->second) {
+                    if(c == ';' || c == ' ') {
+                        c = '_';
+                    }
+                }
+            }
+            os << ';' << it->second;
+        }
+        os << ' ' << stack.second << '\n';
+    }
+}
+
+}  // namespace internal
+}  // namespace lms
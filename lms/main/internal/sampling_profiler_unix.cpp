@@ -0,0 +1,64 @@
+#include <cerrno>
+#include <csignal>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "lms/internal/sampling_profiler.h"
+
+namespace lms {
+namespace internal {
+
+void SamplingProfiler::handleSignal(int signal) {
+    (void)signal;
+
+    // the interrupted code may inspect errno right after the signal
+    int savedErrno = errno;
+
+    // announced before loading s_active, see stop()
+    s_inHandler.fetch_add(1);
+    SamplingProfiler *profiler = s_active.load();
+    if(profiler != nullptr) {
+        profiler->sample();
+    }
+    s_inHandler.fetch_sub(1);
+
+    errno = savedErrno;
+}
+
+void SamplingProfiler::blockSignal() {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGPROF);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+}
+
+bool SamplingProfiler::startTimer() {
+    if(m_frequency <= 0) {
+        return false;
+    }
+
+    struct sigaction action;
+    action.sa_handler = handleSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    if(sigaction(SIGPROF, &action, nullptr) != 0) {
+        return false;
+    }
+
+    long interval = 1000000 / m_frequency;
+    struct itimerval timer;
+    timer.it_interval.tv_sec = interval / 1000000;
+    timer.it_interval.tv_usec = interval % 1000000;
+    timer.it_value = timer.it_interval;
+    return setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+}
+
+void SamplingProfiler::stopTimer() {
+    // the handler stays installed, a pending SIGPROF would terminate the
+    // process otherwise
+    struct itimerval timer = {{0, 0}, {0, 0}};
+    setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+}  // namespace internal
+}  // namespace lms
@@ -0,0 +1,20 @@
+#include "lms/internal/sampling_profiler.h"
+
+namespace lms {
+namespace internal {
+
+void SamplingProfiler::handleSignal(int signal) {
+    (void)signal;
+}
+
+void SamplingProfiler::blockSignal() {}
+
+bool SamplingProfiler::startTimer() {
+    // there is no SIGPROF equivalent, see start()
+    return false;
+}
+
+void SamplingProfiler::stopTimer() {}
+
+}  // namespace internal
+}  // namespace lms
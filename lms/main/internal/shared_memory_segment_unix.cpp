@@ -0,0 +1,218 @@
+#include "lms/internal/shared_memory_segment.h"
+#include "lms/extra/string.h"
+
+#include <cstring>
+#include <cerrno>
+#include <thread>
+#include <chrono>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace lms {
+namespace internal {
+
+constexpr std::uint32_t SharedMemorySegment::MAGIC;
+constexpr std::uint32_t SharedMemorySegment::VERSION;
+constexpr int SharedMemorySegment::READ_RETRIES;
+
+namespace {
+
+// the payload starts on its own cache line
+constexpr std::size_t PAYLOAD_OFFSET = 64;
+static_assert(sizeof(SharedMemorySegment::Header) <= PAYLOAD_OFFSET,
+              "Header does not fit in front of the payload");
+
+// how long to wait for another process to initialize a new segment
+constexpr int INIT_RETRIES = 100;
+constexpr std::chrono::milliseconds INIT_RETRY_DELAY(10);
+
+}  // namespace
+
+SharedMemorySegment::SharedMemorySegment() : m_size(0), m_mappedSize(0),
+    m_mapped(nullptr), m_header(nullptr), m_payload(nullptr) {}
+
+SharedMemorySegment::~SharedMemorySegment() {
+    close();
+}
+
+bool SharedMemorySegment::open(const std::string &name, std::size_t size,
+                               std::uint64_t typeHash) {
+    close();
+
+    std::size_t mappedSize = PAYLOAD_OFFSET + size;
+    bool creator = true;
+
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0666);
+    if(fd == -1 && errno == EEXIST) {
+        creator = false;
+        fd = shm_open(name.c_str(), O_RDWR, 0666);
+    }
+
+    if(fd == -1) {
+        m_error = std::string("shm_open failed: ") + std::strerror(errno);
+        return false;
+    }
+
+    if(creator) {
+        if(ftruncate(fd, mappedSize) == -1) {
+            m_error = std::string("ftruncate failed: ") + std::strerror(errno);
+            ::close(fd);
+            shm_unlink(name.c_str());
+            return false;
+        }
+    } else {
+        // the creating process may not have resized the segment yet
+        struct stat st;
+        int retries = 0;
+        while(fstat(fd, &st) == 0 && st.st_size == 0 && retries++ < INIT_RETRIES) {
+            std::this_thread::sleep_for(INIT_RETRY_DELAY);
+        }
+
+        if(static_cast<std::size_t>(st.st_size) != mappedSize) {
+            m_error = "segment has " + std::to_string(st.st_size) +
+                " bytes, expected " + std::to_string(mappedSize);
+            ::close(fd);
+            return false;
+        }
+    }
+
+    void *mapped = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if(mapped == MAP_FAILED) {
+        m_error = std::string("mmap failed: ") + std::strerror(errno);
+        return false;
+    }
+
+    Header *header = static_cast<Header*>(mapped);
+
+    if(creator) {
+        // new segments are zero filled
+        header->version = VERSION;
+        header->typeHash = typeHash;
+        header->size = size;
+        header->sequence.store(0, std::memory_order_relaxed);
+        header->magic.store(MAGIC, std::memory_order_release);
+    } else {
+        int retries = 0;
+        while(header->magic.load(std::memory_order_acquire) != MAGIC &&
+              retries++ < INIT_RETRIES) {
+            std::this_thread::sleep_for(INIT_RETRY_DELAY);
+        }
+
+        m_error.clear();
+        if(header->magic.load(std::memory_order_acquire) != MAGIC) {
+            m_error = "segment was never initialized";
+        } else if(header->version != VERSION) {
+            m_error = "segment has version " + std::to_string(header->version) +
+                ", expected " + std::to_string(VERSION);
+        } else if(header->typeHash != typeHash || header->size != size) {
+            m_error = "segment holds a different type";
+        }
+
+        if(! m_error.empty()) {
+            munmap(mapped, mappedSize);
+            return false;
+        }
+    }
+
+    m_name = name;
+    m_size = size;
+    m_mappedSize = mappedSize;
+    m_mapped = mapped;
+    m_header = header;
+    m_payload = static_cast<unsigned char*>(mapped) + PAYLOAD_OFFSET;
+    m_scratch.resize(size);
+    return true;
+}
+
+void SharedMemorySegment::close() {
+    if(m_mapped != nullptr) {
+        munmap(m_mapped, m_mappedSize);
+    }
+
+    m_mapped = nullptr;
+    m_header = nullptr;
+    m_payload = nullptr;
+    m_scratch.clear();
+    m_size = 0;
+    m_mappedSize = 0;
+}
+
+bool SharedMemorySegment::isOpen() const {
+    return m_mapped != nullptr;
+}
+
+void SharedMemorySegment::write(const void *data, Provenance const& provenance) {
+    std::uint64_t seq = m_header->sequence.load(std::memory_order_relaxed);
+
+    m_header->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(m_payload, data, m_size);
+    m_header->originMicros = provenance.origin.micros();
+    m_header->originSource = provenance.source;
+
+    m_header->sequence.store(seq + 2, std::memory_order_release);
+}
+
+bool SharedMemorySegment::read(void *data, std::uint64_t &lastSequence,
+                               Provenance *provenance) {
+    for(int i = 0; i < READ_RETRIES; i++) {
+        std::uint64_t before = m_header->sequence.load(std::memory_order_acquire);
+
+        if(before == lastSequence) {
+            return false;
+        }
+
+        if(before & 1) {
+            // the writer is copying right now
+            std::this_thread::yield();
+            continue;
+        }
+
+        // copy into the scratch buffer first, the caller must never see
+        // a value that was torn by a concurrent write
+        std::memcpy(m_scratch.data(), m_payload, m_size);
+        std::int64_t originMicros = m_header->originMicros;
+        std::uint64_t originSource = m_header->originSource;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        std::uint64_t after = m_header->sequence.load(std::memory_order_relaxed);
+
+        if(before == after) {
+            std::memcpy(data, m_scratch.data(), m_size);
+            if(provenance != nullptr) {
+                provenance->origin = Time::fromMicros(originMicros);
+                provenance->source = originSource;
+            }
+            lastSequence = before;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::size_t SharedMemorySegment::size() const {
+    return m_size;
+}
+
+const std::string& SharedMemorySegment::name() const {
+    return m_name;
+}
+
+const std::string& SharedMemorySegment::error() const {
+    return m_error;
+}
+
+std::uint64_t SharedMemorySegment::hashTypeName(const std::string &typeName) {
+    // std::hash is not guaranteed to be equal in different binaries
+    return extra::stableHash(typeName);
+}
+
+}  // namespace internal
+}  // namespace lms
@@ -0,0 +1,63 @@
+#include "lms/internal/shared_memory_segment.h"
+#include "lms/extra/string.h"
+
+namespace lms {
+namespace internal {
+
+constexpr std::uint32_t SharedMemorySegment::MAGIC;
+constexpr std::uint32_t SharedMemorySegment::VERSION;
+constexpr int SharedMemorySegment::READ_RETRIES;
+
+SharedMemorySegment::SharedMemorySegment() : m_size(0), m_mappedSize(0),
+    m_mapped(nullptr), m_header(nullptr), m_payload(nullptr) {}
+
+SharedMemorySegment::~SharedMemorySegment() {
+    close();
+}
+
+bool SharedMemorySegment::open(const std::string &name, std::size_t size,
+                               std::uint64_t typeHash) {
+    (void)name;
+    (void)size;
+    (void)typeHash;
+    m_error = "shared memory channels are not supported on Windows";
+    return false;
+}
+
+void SharedMemorySegment::close() {}
+
+bool SharedMemorySegment::isOpen() const {
+    return false;
+}
+
+void SharedMemorySegment::write(const void *data, Provenance const& provenance) {
+    (void)data;
+    (void)provenance;
+}
+
+bool SharedMemorySegment::read(void *data, std::uint64_t &lastSequence,
+                               Provenance *provenance) {
+    (void)data;
+    (void)lastSequence;
+    (void)provenance;
+    return false;
+}
+
+std::size_t SharedMemorySegment::size() const {
+    return m_size;
+}
+
+const std::string& SharedMemorySegment::name() const {
+    return m_name;
+}
+
+const std::string& SharedMemorySegment::error() const {
+    return m_error;
+}
+
+std::uint64_t SharedMemorySegment::hashTypeName(const std::string &typeName) {
+    return extra::stableHash(typeName);
+}
+
+}  // namespace internal
+}  // namespace lms
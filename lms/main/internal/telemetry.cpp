@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <limits>
+
+#include "lms/internal/telemetry.h"
+#include "lms/endian.h"
+
+namespace lms {
+namespace internal {
+
+namespace {
+
+/* big endian reader that fails once the end is reached */
+class Reader {
+public:
+    Reader(const std::uint8_t *data, std::size_t size) : m_data(data), m_size(size), m_pos(0) {}
+
+    template<typename T>
+    bool get(T &value) {
+        if(m_size - m_pos < sizeof(T)) {
+            return false;
+        }
+        std::copy(m_data + m_pos, m_data + m_pos + sizeof(T), reinterpret_cast<std::uint8_t*>(&value));
+        value = Endian::betoh(value);
+        m_pos += sizeof(T);
+        return true;
+    }
+
+    bool get(std::uint8_t &value) {
+        if(m_size - m_pos < 1) {
+            return false;
+        }
+        value = m_data[m_pos++];
+        return true;
+    }
+
+    bool get(std::string &str, std::size_t len) {
+        if(m_size - m_pos < len) {
+            return false;
+        }
+        str.assign(reinterpret_cast<const char*>(m_data + m_pos), len);
+        m_pos += len;
+        return true;
+    }
+
+    bool end() const {
+        return m_pos == m_size;
+    }
+private:
+    const std::uint8_t *m_data;
+    std::size_t m_size;
+    std::size_t m_pos;
+};
+
+}  // namespace
+
+constexpr std::uint8_t TelemetryEncoder::VERSION;
+constexpr std::size_t TelemetryEncoder::HEADER_LEN;
+
+TelemetryEncoder::TelemetryEncoder()
+    : m_buffer(HEADER_LEN), m_records(0), m_hasBase(false), m_base(Time::ZERO) {}
+
+template<typename T>
+void TelemetryEncoder::put(T value) {
+    value = Endian::htobe(value);
+    const std::uint8_t *bytes = reinterpret_cast<const std::uint8_t*>(&value);
+    m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template<>
+void TelemetryEncoder::put<std::uint8_t>(std::uint8_t value) {
+    m_buffer.push_back(value);
+}
+
+void TelemetryEncoder::begin(Kind kind) {
+    put<std::uint8_t>(kind);
+    m_records++;
+}
+
+void TelemetryEncoder::time(Time time) {
+    if(! m_hasBase) {
+        m_base = time;
+        m_hasBase = true;
+    }
+    put<std::int32_t>(static_cast<std::int32_t>((time - m_base).micros()));
+}
+
+void TelemetryEncoder::mapping(std::uint32_t label, std::string const& name) {
+    std::uint8_t len = static_cast<std::uint8_t>(
+        std::min(name.size(), std::size_t(std::numeric_limits<std::uint8_t>::max())));
+
+    begin(MAPPING);
+    put(label);
+    put(len);
+    m_buffer.insert(m_buffer.end(), name.begin(), name.begin() + len);
+}
+
+void TelemetryEncoder::marker(Kind kind, Time time, std::uint32_t label,
+                              std::uint16_t thread, std::int32_t cycle) {
+    begin(kind);
+    this->time(time);
+    put(label);
+    put(thread);
+    put(cycle);
+}
+
+void TelemetryEncoder::channelStats(Time time, std::uint32_t label,
+                                    ChannelStats::Values const& values) {
+    begin(CHANNEL_STATS);
+    this->time(time);
+    put(label);
+    put(values.reads);
+    put(values.writes);
+    put(values.bytes);
+    put(static_cast<std::int64_t>(values.blockedMicros));
+}
+
+void TelemetryEncoder::counter(Time time, std::uint32_t label, std::int64_t value) {
+    begin(COUNTER);
+    this->time(time);
+    put(label);
+    put(value);
+}
+
+std::uint16_t TelemetryEncoder::records() const {
+    return m_records;
+}
+
+std::size_t TelemetryEncoder::size() const {
+    return m_buffer.size();
+}
+
+DebugServer::Datagram TelemetryEncoder::finish() {
+    // fill in the header
+    std::vector<std::uint8_t> records;
+    records.swap(m_buffer);
+    put(VERSION);
+    put(m_records);
+    put(static_cast<std::int64_t>(m_base.micros()));
+    std::copy(m_buffer.begin(), m_buffer.end(), records.begin());
+
+    DebugServer::Datagram datagram(DebugServer::MessageType::TELEMETRY,
+                                   static_cast<std::uint32_t>(records.size()));
+    std::copy(records.begin(), records.end(), datagram.data());
+
+    m_buffer.assign(HEADER_LEN, 0);
+    m_records = 0;
+    m_hasBase = false;
+    return datagram;
+}
+
+bool TelemetryDecoder::decode(const std::uint8_t *data, std::size_t size,
+                              std::vector<Record> &records) {
+    Reader reader(data, size);
+
+    std::uint8_t version;
+    std::uint16_t count;
+    std::int64_t base;
+    if(! reader.get(version) || version != TelemetryEncoder::VERSION ||
+            ! reader.get(count) || ! reader.get(base)) {
+        return false;
+    }
+
+    for(std::uint16_t i = 0; i < count; i++) {
+        Record record;
+        std::uint8_t kind;
+        if(! reader.get(kind)) {
+            return false;
+        }
+        record.kind = static_cast<TelemetryEncoder::Kind>(kind);
+        record.time = Time::ZERO;
+        record.thread = 0;
+        record.cycle = -1;
+        record.value = 0;
+
+        bool ok = true;
+        std::int32_t delta = 0;
+        switch(record.kind) {
+        case TelemetryEncoder::BEGIN:
+        case TelemetryEncoder::END:
+            ok = reader.get(delta) && reader.get(record.label) &&
+                 reader.get(record.thread) && reader.get(record.cycle);
+            break;
+        case TelemetryEncoder::MAPPING: {
+            std::uint8_t len;
+            ok = reader.get(record.label) && reader.get(len) && reader.get(record.name, len);
+            break;
+        }
+        case TelemetryEncoder::CHANNEL_STATS: {
+            std::int64_t blocked;
+            ok = reader.get(delta) && reader.get(record.label) &&
+                 reader.get(record.values.reads) && reader.get(record.values.writes) &&
+                 reader.get(record.values.bytes) && reader.get(blocked);
+            record.values.blockedMicros = blocked;
+            break;
+        }
+        case TelemetryEncoder::COUNTER:
+            ok = reader.get(delta) && reader.get(record.label) && reader.get(record.value);
+            break;
+        default:
+            return false;
+        }
+
+        if(! ok) {
+            return false;
+        }
+        record.time = Time::fromMicros(base + delta);
+        records.push_back(record);
+    }
+    return reader.end();
+}
+
+}  // namespace internal
+}  // namespace lms
@@ -0,0 +1,133 @@
+#include <algorithm>
+
+#include "lms/internal/trace_profiler.h"
+
+namespace lms {
+namespace internal {
+
+namespace {
+
+void writeString(std::ofstream &stream, std::string const& str) {
+    stream << '"';
+    for(char c : str) {
+        if(c == '"' || c == '\\') {
+            stream << '\\' << c;
+        } else if(static_cast<unsigned char>(c) < 0x20) {
+            stream << ' ';
+        } else {
+            stream << c;
+        }
+    }
+    stream << '"';
+}
+
+}  // namespace
+
+TraceProfiler::TraceProfiler(std::string const& file)
+    : m_first(true), m_numThreads(0) {
+    m_stream.open(file);
+    m_stream << "[";
+}
+
+TraceProfiler::~TraceProfiler() {
+    if(m_stream.is_open()) {
+        m_stream << "\n]\n";
+        m_stream.close();
+    }
+}
+
+void TraceProfiler::onLabel(Profiler::LabelId id, std::string const& label) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    size_t dot = label.find('.');
+    std::string runtime = label.substr(0, dot);
+
+    Label info;
+    info.name = dot == std::string::npos ? "" : label.substr(dot + 1);
+    info.value = label.substr(label.rfind('.') + 1);
+
+    auto it = std::find(m_runtimes.begin(), m_runtimes.end(), runtime);
+    info.pid = static_cast<int>(it - m_runtimes.begin());
+    if(it == m_runtimes.end()) {
+        m_runtimes.push_back(runtime);
+
+        beginEvent('M', "process_name", Time::ZERO, info.pid);
+        m_stream << ",\"args\":{\"name\":";
+        writeString(m_stream, runtime);
+        m_stream << "}}";
+    }
+
+    if(m_labels.size() <= id) {
+        m_labels.resize(id + 1);
+    }
+    m_labels[id] = info;
+}
+
+int TraceProfiler::lane(int pid) {
+    int tid = m_tid.get([this](int &tid) {
+        tid = m_numThreads++;
+    });
+
+    std::uint32_t key = (static_cast<std::uint32_t>(pid) << 16) | tid;
+    if(std::find(m_namedLanes.begin(), m_namedLanes.end(), key) == m_namedLanes.end()) {
+        m_namedLanes.push_back(key);
+
+        beginEvent('M', "thread_name", Time::ZERO, pid);
+        m_stream << ",\"tid\":" << tid
+                 << ",\"args\":{\"name\":\"thread " << tid << "\"}}";
+    }
+    return tid;
+}
+
+void TraceProfiler::beginEvent(char phase, std::string const& name, Time now, int pid) {
+    m_stream << (m_first ? "\n" : ",\n") << "{\"name\":";
+    writeString(m_stream, name);
+    m_stream << ",\"ph\":\"" << phase << "\",\"ts\":" << now.micros()
+             << ",\"pid\":" << pid;
+    m_first = false;
+}
+
+void TraceProfiler::onMarker(Profiler::Type type, Time now, Profiler::LabelId id,
+                             std::string const& label) {
+    (void)label;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Label const& info = m_labels[id];
+    int tid = lane(info.pid);
+    bool cycle = info.name.empty();
+
+    beginEvent(type == Profiler::BEGIN ? 'B' : 'E', cycle ? "cycle" : info.name,
+               now, info.pid);
+    m_stream << ",\"tid\":" << tid << ",\"cat\":\"" << (cycle ? "cycle" : "module") << "\"";
+    if(type == Profiler::BEGIN) {
+        m_stream << ",\"args\":{\"cycle\":" << Profiler::currentCycle() << "}";
+    }
+    m_stream << "}";
+}
+
+void TraceProfiler::onChannelStats(Time now, Profiler::LabelId id, std::string const& label,
+                                   ChannelStats::Values const& values) {
+    (void)label;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Label const& info = m_labels[id];
+    beginEvent('C', info.name, now, info.pid);
+    m_stream << ",\"args\":{\"reads\":" << values.reads << ",\"writes\":" << values.writes
+             << ",\"bytes\":" << values.bytes << ",\"blocked\":" << values.blockedMicros
+             << "}}";
+}
+
+void TraceProfiler::onCounter(Time now, Profiler::LabelId id, std::string const& label,
+                              std::int64_t value) {
+    (void)label;
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Label const& info = m_labels[id];
+    beginEvent('C', info.name, now, info.pid);
+    m_stream << ",\"args\":{";
+    writeString(m_stream, info.value);
+    m_stream << ":" << value << "}}";
+}
+
+}  // namespace internal
+}  // namespace lms
@@ -200,6 +200,7 @@ void XmlParser::parseExecution(pugi::xml_node node, Runtime *runtime) {
     pugi::xml_node clockNode = node.child("clock");
     pugi::xml_node mainThreadNode = node.child("mainThread");
     pugi::xml_node pausedNode = node.child("paused");
+    pugi::xml_node hugePagesNode = node.child("hugePages");
 
     Clock& clock = runtime->clock();
 
@@ -276,6 +277,10 @@ void XmlParser::parseExecution(pugi::xml_node node, Runtime *runtime) {
     if(pausedNode) {
         runtime->pause();
     }
+
+    if(hugePagesNode) {
+        runtime->dataManager().arena().hugePages(true);
+    }
 }
 
 void XmlParser::parseInclude(pugi::xml_node node,
@@ -383,6 +388,7 @@ void XmlParser::parseModules(pugi::xml_node node,
         pugi::xml_attribute nameAttr = channelNode.attribute("name");
         pugi::xml_attribute mapToAttr = channelNode.attribute("mapTo");
         pugi::xml_attribute priorityAttr = channelNode.attribute("priority");
+        pugi::xml_attribute fromRuntimeAttr = channelNode.attribute("fromRuntime");
 
         if(! nameAttr) {
             errorMissingAttr(channelNode, nameAttr);
@@ -393,10 +399,15 @@ void XmlParser::parseModules(pugi::xml_node node,
             module->channelMapping[nameAttr.value()] = mapToAttr.value();
         }
 
+        std::string mapTo = mapToAttr ? mapToAttr.value() : nameAttr.value();
+
         if(priorityAttr) {
-            std::string mapTo = mapToAttr ? mapToAttr.value() : nameAttr.value();
             module->channelPriorities[mapTo] = priorityAttr.as_int();
         }
+
+        if(fromRuntimeAttr) {
+            module->channelRuntimes[mapTo] = fromRuntimeAttr.value();
+        }
     }
 
     // parse all config
@@ -518,6 +529,73 @@ void XmlParser::parseService(pugi::xml_node node, const std::string &currentFile
     }
 }
 
+void XmlParser::parseChannel(pugi::xml_node node, LoadConfigFlag flag) {
+    pugi::xml_attribute nameAttr = node.attribute("name");
+    pugi::xml_attribute sharedMemoryAttr = node.attribute("sharedMemory");
+    pugi::xml_attribute queueCapacityAttr = node.attribute("queueCapacity");
+    pugi::xml_attribute poolSizeAttr = node.attribute("poolSize");
+
+    if(! nameAttr) {
+        errorMissingAttr(node, nameAttr);
+        return;
+    }
+
+    if(flag == LoadConfigFlag::ONLY_MODULE_CONFIG) {
+        // channels cannot be reconfigured at runtime
+        return;
+    }
+
+    DataManager::ChannelConfig &config =
+        m_runtime->dataManager().channelConfig(nameAttr.value());
+
+    if(sharedMemoryAttr) {
+        std::string segment = sharedMemoryAttr.value();
+        if(segment.size() < 2 || segment[0] != '/' ||
+                segment.find('/', 1) != std::string::npos) {
+            errorInvalidAttr(node, sharedMemoryAttr, "/name");
+        } else {
+            config.sharedMemory = segment;
+        }
+    }
+
+    if(queueCapacityAttr) {
+        if(queueCapacityAttr.as_int() <= 0) {
+            errorInvalidAttr(node, queueCapacityAttr, "positive integer");
+        } else {
+            config.queueCapacity = queueCapacityAttr.as_uint();
+        }
+    }
+
+    if(poolSizeAttr) {
+        if(poolSizeAttr.as_int() <= 0) {
+            errorInvalidAttr(node, poolSizeAttr, "positive integer");
+        } else {
+            config.poolSize = poolSizeAttr.as_uint();
+        }
+    }
+}
+
+void XmlParser::parseLatency(pugi::xml_node node, LoadConfigFlag flag) {
+    pugi::xml_attribute fromAttr = node.attribute("from");
+    pugi::xml_attribute toAttr = node.attribute("to");
+
+    if(! fromAttr) {
+        errorMissingAttr(node, fromAttr);
+        return;
+    }
+
+    if(! toAttr) {
+        errorMissingAttr(node, toAttr);
+        return;
+    }
+
+    if(flag == LoadConfigFlag::ONLY_MODULE_CONFIG) {
+        return;
+    }
+
+    m_runtime->dataManager().traceLatency(fromAttr.value(), toAttr.value());
+}
+
 void XmlParser::parseFile(const std::string &file, LoadConfigFlag flag) {
     std::ifstream ifs(file);
 
@@ -553,6 +631,10 @@ void XmlParser::parseFile(const std::string &file, LoadConfigFlag flag) {
             parseRuntime(node, file, flag);
         } else if(std::string("service") == node.name()) {
             parseService(node, file, flag);
+        } else if(std::string("channel") == node.name()) {
+            parseChannel(node, flag);
+        } else if(std::string("latency") == node.name()) {
+            parseLatency(node, flag);
         } else {
             errorUnknownNode(node);
         }
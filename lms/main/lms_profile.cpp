@@ -0,0 +1,49 @@
+#include <iostream>
+#include <cstdlib>
+
+#include "lms/internal/profile_analyzer.h"
+#include "tclap/CmdLine.h"
+#include "lms/definitions.h"
+
+/**
+ * @brief Analyze a profile written with lms --profiling, or compare two
+ * profiles.
+ *
+ * @return EXIT_FAILURE if a file cannot be read or a comparison found
+ * regressions
+ */
+int main(int argc, char *argv[]) {
+    TCLAP::CmdLine cmd("lms-profile - analyze LMS profiling output", ' ', LMS_VERSION_STRING);
+    TCLAP::UnlabeledValueArg<std::string> fileArg("file",
+        "Profile written by lms --profiling (csv or binary)",
+        true, "", "path", cmd);
+    TCLAP::ValueArg<std::string> compareArg("", "compare",
+        "Compare the mean and p99 of all labels against this baseline profile",
+        false, "", "path", cmd);
+    TCLAP::ValueArg<double> thresholdArg("", "threshold",
+        "Relative increase in percent that is flagged as a regression",
+        false, 10, "percent", cmd);
+    cmd.parse(argc, argv);
+
+    lms::internal::ProfileAnalyzer profile;
+    if(! profile.load(fileArg.getValue())) {
+        std::cerr << "Could not read " << fileArg.getValue() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if(! compareArg.isSet()) {
+        profile.print(std::cout);
+        return EXIT_SUCCESS;
+    }
+
+    lms::internal::ProfileAnalyzer base;
+    if(! base.load(compareArg.getValue())) {
+        std::cerr << "Could not read " << compareArg.getValue() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    int regressions = lms::internal::ProfileAnalyzer::compare(
+        base, profile, thresholdArg.getValue() / 100, std::cout);
+    std::cout << "\n" << regressions << " regressions" << std::endl;
+    return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
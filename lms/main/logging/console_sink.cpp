@@ -17,16 +17,14 @@ void ConsoleSink::sink(const Event &message) {
     std::lock_guard<std::mutex> lck(mtx);
 
     if(m_time) {
-        // get time now
-        time_t rawtime;
-        std::time(&rawtime);
-        struct tm *now = std::localtime(&rawtime);
-
-        // format time to "HH:MM:SS"
-        char buffer[10];
-        std::strftime(buffer, 10, "%T", now);
-
-        m_out << buffer << " ";
+        // format time to "HH:MM:SS", once per second
+        if(m_lastTime != message.timestamp || m_lastTime == 0) {
+            m_lastTime = message.timestamp;
+            struct tm *now = std::localtime(&m_lastTime);
+            std::strftime(m_timeBuffer, sizeof(m_timeBuffer), "%T", now);
+        }
+
+        m_out << m_timeBuffer << " ";
     }
     if(m_colored) {
         m_out << levelColor(message.level);
@@ -35,7 +33,12 @@ void ConsoleSink::sink(const Event &message) {
     if(m_colored) {
         m_out << lms::extra::COLOR_WHITE;
     }
-    m_out << " " << message.messageText() << std::endl;
+    m_out << " " << message.messageText() << '\n';
+}
+
+void ConsoleSink::flush() {
+    std::lock_guard<std::mutex> lck(mtx);
+    m_out.flush();
 }
 
 } // namespace logging
@@ -1,16 +1,61 @@
 #include <memory>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <limits>
 
 #include <lms/logger.h>
 
 namespace lms {
 namespace logging {
 
+namespace {
+
+/* set in the background thread of any context */
+thread_local bool inWorker = false;
+
+const std::size_t WORKER_BATCH = 256;
+
+std::size_t levelIndex(Level level) {
+    return std::min(static_cast<std::size_t>(level), std::size_t(4));
+}
+
+}  // namespace
+
+constexpr std::size_t Context::QueuedEvent::INLINE_SIZE;
+
+void Context::QueuedEvent::assign(const std::string &tag, const std::string &text) {
+    tagLength = static_cast<std::uint16_t>(std::min(tag.size(), std::size_t(std::numeric_limits<std::uint16_t>::max())));
+    textLength = static_cast<std::uint32_t>(std::min(text.size(), std::size_t(std::numeric_limits<std::uint32_t>::max())));
+
+    if(tagLength + std::size_t(textLength) <= INLINE_SIZE) {
+        std::memcpy(data, tag.data(), tagLength);
+        std::memcpy(data + tagLength, text.data(), textLength);
+        overflow.clear();
+    } else {
+        overflow.assign(tag, 0, tagLength);
+        overflow.append(text, 0, textLength);
+    }
+}
+
+const char* Context::QueuedEvent::begin() const {
+    return overflow.empty() ? data : overflow.data();
+}
+
 Context& Context::getDefault() {
     static Context ctx;
     return ctx;
 }
 
-Context::Context() {
+Context::Context() : m_async(false), m_policy(OverflowPolicy::BLOCK),
+    m_producers(0), m_enqueued(0), m_processed(0), m_sleeping(false), m_running(false) {
+    for(auto &dropped : m_dropped) {
+        dropped.store(0);
+    }
+}
+
+Context::~Context() {
+    async(false);
 }
 
 void Context::appendSink(Sink *sink) {
@@ -34,11 +79,189 @@ Filter* Context::filter() const {
 }
 
 void Context::processMessage(const Event &message) {
+    if(! inWorker && m_async.load(std::memory_order_acquire) && enqueue(message)) {
+        return;
+    }
+    sink(message);
+}
+
+void Context::sink(const Event &message) {
     for(size_t i = 0; i < m_sinks.size(); i++) {
         m_sinks[i]->sink(message);
     }
+
+    // the background thread flushes once per batch
+    if(! inWorker) {
+        for(size_t i = 0; i < m_sinks.size(); i++) {
+            m_sinks[i]->flush();
+        }
+    }
+}
+
+void Context::async(bool enable, std::size_t capacity, OverflowPolicy policy) {
+    if(enable == m_async.load()) {
+        return;
+    }
+
+    if(enable) {
+        m_queue.reset(new extra::BoundedQueue<QueuedEvent>(capacity));
+        m_policy = policy;
+        m_running = true;
+        m_thread = std::thread([this]() {
+            worker();
+        });
+        m_async.store(true);
+        return;
+    }
+
+    // pairs with the increment of m_producers in enqueue(): either the
+    // producer sees async mode off or it is counted here
+    m_async.store(false);
+    while(m_producers.load() > 0) {
+        std::this_thread::yield();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+
+    // events pushed while the background thread was stopping
+    QueuedEvent queued;
+    std::string tag;
+    while(m_queue->pop(queued)) {
+        sinkQueued(queued, tag);
+    }
+    m_queue.reset();
+}
+
+bool Context::async() const {
+    return m_async.load();
+}
+
+bool Context::enqueue(const Event &message) {
+    m_producers.fetch_add(1);
+    if(! m_async.load()) {
+        m_producers.fetch_sub(1);
+        return false;
+    }
+
+    if(m_policy == OverflowPolicy::DROP_DEBUG_FIRST && message.level <= Level::DEBUG &&
+            m_queue->sizeApprox() >= m_queue->capacity() / 4 * 3) {
+        drop(message.level);
+        m_producers.fetch_sub(1);
+        return true;
+    }
+
+    QueuedEvent queued;
+    queued.level = message.level;
+    queued.timestamp = message.timestamp;
+    queued.assign(message.tag, message.messageText());
+
+    // push() leaves the event untouched if the queue is full
+    while(! m_queue->push(std::move(queued))) {
+        if(m_policy != OverflowPolicy::BLOCK) {
+            drop(message.level);
+            m_producers.fetch_sub(1);
+            return true;
+        }
+        if(! m_async.load()) {
+            // async mode is being switched off, do not wait for the queue
+            m_producers.fetch_sub(1);
+            return false;
+        }
+        wake();
+        std::this_thread::yield();
+    }
+    m_enqueued.fetch_add(1);
+
+    if(m_sleeping.load()) {
+        wake();
+    }
+    m_producers.fetch_sub(1);
+    return true;
+}
+
+void Context::sinkQueued(QueuedEvent const& queued, std::string &tag) {
+    const char *data = queued.begin();
+    tag.assign(data, queued.tagLength);
+
+    // sinked by processMessage() in the destructor
+    Event event(*this, queued.level, tag, queued.timestamp);
+    event.messageStream.write(data + queued.tagLength, queued.textLength);
+}
+
+void Context::drop(Level level) {
+    m_dropped[levelIndex(level)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void Context::wake() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cv.notify_one();
+}
+
+void Context::flush() {
+    if(! m_async.load()) {
+        return;
+    }
+
+    std::uint64_t target = m_enqueued.load();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(m_processed.load() < target && m_running) {
+        m_cv.notify_one();
+        m_processedCv.wait_for(lock, std::chrono::milliseconds(10));
+    }
+}
+
+std::uint64_t Context::dropped() const {
+    std::uint64_t sum = 0;
+    for(auto const& dropped : m_dropped) {
+        sum += dropped.load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+std::uint64_t Context::dropped(Level level) const {
+    return m_dropped[levelIndex(level)].load(std::memory_order_relaxed);
+}
+
+void Context::worker() {
+    inWorker = true;
+    std::vector<QueuedEvent> batch;
+    std::string tag;
+
+    while(true) {
+        batch.clear();
+        m_queue->popAll(batch, WORKER_BATCH);
+
+        if(batch.empty()) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if(! m_running) {
+                break;
+            }
+            m_sleeping.store(true);
+            if(m_queue->sizeApprox() == 0) {
+                // the timeout covers a wake-up that raced with going to sleep
+                m_cv.wait_for(lock, std::chrono::milliseconds(10));
+            }
+            m_sleeping.store(false);
+            continue;
+        }
+
+        for(QueuedEvent const& queued : batch) {
+            sinkQueued(queued, tag);
+        }
+        for(size_t i = 0; i < m_sinks.size(); i++) {
+            m_sinks[i]->flush();
+        }
+
+        m_processed.fetch_add(batch.size());
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_processedCv.notify_all();
+    }
 }
 
 } // namespace logging
 } // namespace lms
-
@@ -12,8 +12,8 @@ DebugServerSink::DebugServerSink(internal::DebugServer *server) : m_server(serve
 void DebugServerSink::sink(const Event &message) {
     constexpr std::uint8_t MAX_LEN = std::numeric_limits<std::uint8_t>::max();
 
-    std::string text = message.messageText();
-    std::string tag = message.tag;
+    const std::string &text = message.messageText();
+    const std::string &tag = message.tag;
 
     uint8_t tagLen = std::min(size_t(MAX_LEN), tag.size());
     uint8_t textLen = std::min(size_t(MAX_LEN), text.size());
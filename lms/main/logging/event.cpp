@@ -1,12 +1,200 @@
 #include <memory>
+#include <vector>
+#include <cstdlib>
+#include <new>
 
 #include <lms/logger.h>
 
 namespace lms {
 namespace logging {
 
+namespace {
+
+/* events and storages kept per thread */
+const std::size_t MAX_POOLED = 16;
+
+/* storages whose text grew beyond this are not reused */
+const std::size_t MAX_POOLED_TEXT = 16384;
+
+/* set once the pool of the thread is destroyed, e.g. for events logged
+ * by static destructors */
+thread_local bool poolDestroyed = false;
+
+/**
+ * @brief Stream buffer that formats into a fixed-size array and appends to
+ * a string only if the array is full or the text is needed.
+ */
+class MessageBuffer : public std::streambuf {
+public:
+    MessageBuffer() {
+        reset();
+    }
+
+    const std::string& str() {
+        sync();
+        return m_text;
+    }
+
+    void clear() {
+        m_text.clear();
+        reset();
+    }
+
+    std::size_t capacity() const {
+        return m_text.capacity();
+    }
+protected:
+    int_type overflow(int_type c) override {
+        sync();
+        if(! traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+        m_text.append(pbase(), pptr() - pbase());
+        reset();
+        return 0;
+    }
+private:
+    void reset() {
+        setp(m_data, m_data + sizeof(m_data));
+    }
+
+    char m_data[256];
+    std::string m_text;
+};
+
+}  // namespace
+
+struct Event::Storage {
+    Storage() : stream(&buffer) {
+        tag.reserve(64);
+    }
+
+    /**
+     * @brief Take a storage from the pool of the calling thread.
+     */
+    static Storage* acquire();
+
+    /**
+     * @brief Return a storage to the pool of the calling thread.
+     */
+    static void release(Storage *storage);
+
+    static void* allocateEvent(std::size_t size);
+    static void freeEvent(void *ptr);
+
+    std::string tag;
+    MessageBuffer buffer;
+    std::ostream stream;
+private:
+    struct Pool {
+        Pool() {
+            storages.reserve(MAX_POOLED);
+            events.reserve(MAX_POOLED);
+        }
+
+        ~Pool() {
+            for(Storage *storage : storages) {
+                delete storage;
+            }
+            for(void *event : events) {
+                ::operator delete(event);
+            }
+            poolDestroyed = true;
+        }
+
+        std::vector<Storage*> storages;
+        std::vector<void*> events;
+    };
+
+    static Pool& pool() {
+        thread_local Pool pool;
+        return pool;
+    }
+};
+
+Event::Storage* Event::Storage::acquire() {
+    if(! poolDestroyed) {
+        Pool &p = pool();
+        if(! p.storages.empty()) {
+            Storage *storage = p.storages.back();
+            p.storages.pop_back();
+            return storage;
+        }
+    }
+    return new Storage;
+}
+
+void Event::Storage::release(Storage *storage) {
+    if(poolDestroyed || storage->buffer.capacity() > MAX_POOLED_TEXT) {
+        delete storage;
+        return;
+    }
+
+    Pool &p = pool();
+    if(p.storages.size() == MAX_POOLED) {
+        delete storage;
+        return;
+    }
+
+    // the state of std::ostream after construction
+    storage->buffer.clear();
+    storage->stream.clear();
+    storage->stream.flags(std::ios_base::skipws | std::ios_base::dec);
+    storage->stream.precision(6);
+    storage->stream.width(0);
+    storage->stream.fill(' ');
+    p.storages.push_back(storage);
+}
+
+void* Event::Storage::allocateEvent(std::size_t size) {
+    if(size == sizeof(Event) && ! poolDestroyed) {
+        Pool &p = pool();
+        if(! p.events.empty()) {
+            void *ptr = p.events.back();
+            p.events.pop_back();
+            return ptr;
+        }
+    }
+    return ::operator new(size);
+}
+
+void Event::Storage::freeEvent(void *ptr) {
+    if(! poolDestroyed) {
+        Pool &p = pool();
+        if(p.events.size() < MAX_POOLED) {
+            p.events.push_back(ptr);
+            return;
+        }
+    }
+    ::operator delete(ptr);
+}
+
+Event::Event(Context &ctx, Level level, const std::string& tag, std::time_t timestamp)
+    : m_storage(Storage::acquire()), tag(m_storage->tag), level(level),
+      timestamp(timestamp), ctx(ctx), messageStream(m_storage->stream) {
+    m_storage->tag.assign(tag);
+}
+
 Event::~Event() {
     ctx.processMessage(*this);
+    Storage::release(m_storage);
+}
+
+void* Event::operator new(std::size_t size) {
+    return Storage::allocateEvent(size);
+}
+
+void Event::operator delete(void *ptr) {
+    Storage::freeEvent(ptr);
+}
+
+const std::string& Event::messageText() const {
+    return m_storage->buffer.str();
 }
 
 std::unique_ptr<Event> operator <<(std::unique_ptr<Event> message, std::ostream& (*pf) (std::ostream&))
@@ -35,4 +223,3 @@ std::unique_ptr<Event> operator <<(std::unique_ptr<Event> message, std::ostream&
 
 } // namespace logging
 } // namespace lms
-
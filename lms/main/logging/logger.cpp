@@ -90,20 +90,28 @@ std::unique_ptr<Event> Logger::log(Level lvl, const std::string& tag) {
         return nullptr;
     }
 
-    Filter *filter = context->filter();
+    // cheapest check first, nothing is built for disabled levels
+    if(lvl < threshold) {
+        return nullptr;
+    }
 
-    std::string newTag;
+    Filter *filter = context->filter();
 
-    if(tag.empty()) {
-        // if no tag was given, just use the logger's name
-        newTag = name;
-    } else {
-        // otherwise concatenate with the given tag
-        newTag = name + "." + tag;
+    // if no tag was given, just use the logger's name
+    const std::string *newTag = &name;
+
+    if(! tag.empty()) {
+        // otherwise concatenate with the given tag, reusing the capacity of
+        // the previous concatenation
+        thread_local std::string buffer;
+        buffer.assign(name);
+        buffer += '.';
+        buffer += tag;
+        newTag = &buffer;
     }
 
-    if(lvl >= threshold && (filter == nullptr || filter->decide(lvl, newTag))) {
-        return std::unique_ptr<Event>(new Event(*context, lvl, newTag));
+    if(filter == nullptr || filter->decide(lvl, *newTag)) {
+        return std::unique_ptr<Event>(new Event(*context, lvl, *newTag));
     } else {
         return nullptr;
     }
@@ -1,30 +1,246 @@
 #include "lms/messaging.h"
 
+#include <cstring>
+#include <algorithm>
+
 namespace lms {
 
+namespace {
+
+/* index of the calling thread in its execution manager, -1 if unknown */
+thread_local int currentWorkerIndex = -1;
+
+}  // namespace
+
+constexpr std::size_t Messaging::PAYLOAD_ALIGNMENT;
+constexpr std::size_t Messaging::DEFAULT_SUBSCRIPTION_CAPACITY;
+
 Messaging::Messaging() {}
 
-void Messaging::send(const std::string &command, const std::string &content) {
-    // do not allow concurrent access to the send queue
-    std::lock_guard<std::mutex> lock(mtx);
-    sendQueue[command].push_back(content);
+Messaging::BufferLock::BufferLock(Messaging &messaging) : m_messaging(messaging) {
+    int worker = currentWorkerIndex;
+
+    if(worker >= 0 && static_cast<std::size_t>(worker) < messaging.m_buffers.size()) {
+        m_buffer = &messaging.m_buffers[worker];
+    } else {
+        // not called from a worker thread
+        messaging.m_sharedMutex.lock();
+        m_buffer = &messaging.m_shared;
+    }
+}
+
+Messaging::BufferLock::~BufferLock() {
+    if(m_buffer == &m_messaging.m_shared) {
+        m_messaging.m_sharedMutex.unlock();
+    }
+}
+
+void Messaging::currentWorker(int index) {
+    currentWorkerIndex = index;
+}
+
+void Messaging::workers(int num) {
+    m_buffers.resize(num);
+}
+
+int Messaging::workers() const {
+    return static_cast<int>(m_buffers.size());
 }
 
-const std::list<std::string>& Messaging::receive(const std::string &command) const {
-    MessageQueue::const_iterator it = receiveQueue.find(command);
+Messaging::CommandId Messaging::command(const std::string &command) {
+    std::lock_guard<std::mutex> lock(m_commandsMutex);
 
-    if(it != receiveQueue.end()) {
+    auto it = m_commandIds.find(command);
+    if(it != m_commandIds.end()) {
         return it->second;
-    } else {
-        // we cannot create an empty list here because
-        // we would return a reference to temporary
-        return emptyStringList;
+    }
+
+    CommandId id = static_cast<CommandId>(m_commandIds.size());
+    m_commandIds[command] = id;
+    return id;
+}
+
+void Messaging::append(SendBuffer &buffer, CommandId command, const std::string &content) {
+    if(buffer.used == buffer.messages.size()) {
+        buffer.messages.emplace_back();
+    }
+
+    Message &msg = buffer.messages[buffer.used++];
+    msg.command = command;
+    msg.content.assign(content);
+    msg.isPayload = false;
+}
+
+void Messaging::beginPayload(SendBuffer &buffer) {
+    std::size_t offset = (buffer.bytes.size() + PAYLOAD_ALIGNMENT - 1) /
+            PAYLOAD_ALIGNMENT * PAYLOAD_ALIGNMENT;
+    buffer.bytes.resize(offset);
+    buffer.payloadStart = offset;
+}
+
+void Messaging::appendPayload(SendBuffer &buffer, CommandId command, std::size_t typeHash) {
+    if(buffer.used == buffer.messages.size()) {
+        buffer.messages.emplace_back();
+    }
+
+    Message &msg = buffer.messages[buffer.used++];
+    msg.command = command;
+    msg.isPayload = true;
+    msg.typeHash = typeHash;
+    msg.offset = buffer.payloadStart;
+    msg.size = buffer.bytes.size() - buffer.payloadStart;
+}
+
+void Messaging::send(CommandId command, const std::string &content) {
+    BufferLock lock(*this);
+    append(lock.buffer(), command, content);
+}
+
+void Messaging::send(const std::string &command, const std::string &content) {
+    send(this->command(command), content);
+}
+
+Messaging::MessageView Messaging::receive(CommandId command) const {
+    if(command + 1 >= m_offsets.size()) {
+        // command was not known at the last resetQueue()
+        return MessageView();
+    }
+
+    const std::string *contents = m_contents.data();
+    return MessageView(contents + m_offsets[command], contents + m_offsets[command + 1]);
+}
+
+Messaging::PayloadView Messaging::receivePayloads(CommandId command) const {
+    if(command + 1 >= m_payloadOffsets.size()) {
+        return PayloadView();
+    }
+
+    const Payload *payloads = m_payloads.data();
+    return PayloadView(payloads + m_payloadOffsets[command],
+                       payloads + m_payloadOffsets[command + 1]);
+}
+
+Messaging::MessageView Messaging::receive(const std::string &command) const {
+    CommandId id;
+    {
+        std::lock_guard<std::mutex> lock(m_commandsMutex);
+        auto it = m_commandIds.find(command);
+        if(it == m_commandIds.end()) {
+            return MessageView();
+        }
+        id = it->second;
+    }
+    return receive(id);
+}
+
+Messaging::Subscription Messaging::subscribe(CommandId command, std::size_t capacity) {
+    std::shared_ptr<Subscriber> subscriber =
+            std::make_shared<Subscriber>(command, capacity);
+
+    std::lock_guard<std::mutex> lock(m_subscribersMutex);
+    m_subscribers.push_back(subscriber);
+    return Subscription(subscriber);
+}
+
+Messaging::Subscription Messaging::subscribe(const std::string &command,
+                                             std::size_t capacity) {
+    return subscribe(this->command(command), capacity);
+}
+
+void Messaging::deliver() {
+    std::lock_guard<std::mutex> lock(m_subscribersMutex);
+
+    // the subscription handles are gone, nobody will pop anymore
+    m_subscribers.erase(std::remove_if(m_subscribers.begin(), m_subscribers.end(),
+        [](std::shared_ptr<Subscriber> const& subscriber) {
+            return subscriber.use_count() == 1;
+        }), m_subscribers.end());
+
+    for(std::shared_ptr<Subscriber> const& subscriber : m_subscribers) {
+        for(std::string const& content : receive(subscriber->command)) {
+            if(! subscriber->queue.push(content)) {
+                subscriber->drops.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
     }
 }
 
 void Messaging::resetQueue() {
-    receiveQueue = std::move(sendQueue);
-    sendQueue.clear();
+    // lock first: all messages in the shared buffer have known commands
+    std::lock_guard<std::mutex> lock(m_sharedMutex);
+
+    std::size_t numCommands;
+    {
+        std::lock_guard<std::mutex> commandsLock(m_commandsMutex);
+        numCommands = m_commandIds.size();
+    }
+
+    // count messages and payload bytes per command
+    m_offsets.assign(numCommands + 1, 0);
+    m_payloadOffsets.assign(numCommands + 1, 0);
+    std::size_t totalBytes = 0;
+
+    auto count = [this, &totalBytes](SendBuffer const& buffer) {
+        for(std::size_t i = 0; i < buffer.used; i++) {
+            Message const& msg = buffer.messages[i];
+            if(msg.isPayload) {
+                m_payloadOffsets[msg.command + 1]++;
+            } else {
+                m_offsets[msg.command + 1]++;
+            }
+        }
+        totalBytes += buffer.bytes.size() + PAYLOAD_ALIGNMENT;
+    };
+
+    count(m_shared);
+    for(SendBuffer const& buffer : m_buffers) {
+        count(buffer);
+    }
+
+    for(std::size_t i = 1; i <= numCommands; i++) {
+        m_offsets[i] += m_offsets[i - 1];
+        m_payloadOffsets[i] += m_payloadOffsets[i - 1];
+    }
+
+    // swap contents instead of copying them, both sides keep their memory
+    m_contents.resize(m_offsets[numCommands]);
+    m_cursors.assign(m_offsets.begin(), m_offsets.end() - 1);
+
+    // payloads are copied into one buffer that must not grow while
+    // payloads point into it
+    m_payloads.resize(m_payloadOffsets[numCommands]);
+    m_payloadBytes.resize(std::max(m_payloadBytes.size(), totalBytes));
+    m_payloadCursors.assign(m_payloadOffsets.begin(), m_payloadOffsets.end() - 1);
+    std::size_t bytesUsed = 0;
+
+    auto merge = [this, &bytesUsed](SendBuffer &buffer) {
+        // keep the alignment of all payloads in the buffer
+        bytesUsed = (bytesUsed + PAYLOAD_ALIGNMENT - 1) / PAYLOAD_ALIGNMENT * PAYLOAD_ALIGNMENT;
+        unsigned char *bytes = m_payloadBytes.data() + bytesUsed;
+        if(! buffer.bytes.empty()) {
+            std::memcpy(bytes, buffer.bytes.data(), buffer.bytes.size());
+        }
+        bytesUsed += buffer.bytes.size();
+
+        for(std::size_t i = 0; i < buffer.used; i++) {
+            Message &msg = buffer.messages[i];
+            if(msg.isPayload) {
+                m_payloads[m_payloadCursors[msg.command]++] =
+                    Payload(msg.typeHash, bytes + msg.offset, msg.size);
+            } else {
+                m_contents[m_cursors[msg.command]++].swap(msg.content);
+            }
+        }
+        buffer.used = 0;
+        buffer.bytes.clear();
+    };
+
+    merge(m_shared);
+    for(SendBuffer &buffer : m_buffers) {
+        merge(buffer);
+    }
+
+    deliver();
 }
 
 }  // namespace lms
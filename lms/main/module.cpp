@@ -56,6 +56,10 @@ namespace lms{
         return m_executionManager->cycleCounter();
     }
 
+    void Module::skipIfUnchanged(bool skip) {
+        m_wrapper->skipIfUnchanged = skip;
+    }
+
     bool Module::pauseRuntime(std::string const& name) {
         if(! m_wrapper->runtime()->framework().hasRuntime(name)) {
             return false;
@@ -78,6 +82,35 @@ namespace lms{
         return true;
     }
 
+    Messaging::Subscription Module::subscribe(std::string const& command,
+                                              std::size_t capacity,
+                                              std::string const& runtime) {
+        if(runtime.empty()) {
+            return m_messaging->subscribe(command, capacity);
+        }
+
+        internal::Framework &framework = m_wrapper->runtime()->framework();
+        if(! framework.hasRuntime(runtime)) {
+            logger.error("subscribe") << "Runtime " << runtime << " not found";
+            return Messaging::Subscription();
+        }
+
+        return framework.getRuntimeByName(runtime)->executionManager()
+                .messaging().subscribe(command, capacity);
+    }
+
+    bool Module::latencyHistogram(extra::LatencyHistogram &hist,
+                                  std::string const& label) const {
+        internal::HistogramProfiler *histograms =
+            m_wrapper->runtime()->framework().histograms();
+        if(histograms == nullptr) {
+            return false;
+        }
+
+        return histograms->recent(label.empty() ?
+            m_wrapper->runtime()->name() + "." + getName() : label, hist);
+    }
+
     bool Module::isEnableSave() const {
         return m_wrapper->runtime()->framework().isEnableSave();
     }
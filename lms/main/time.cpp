@@ -70,6 +70,22 @@ Time Time::now() {
 
 #endif
 
+#if defined(_WIN32) || ! defined(CLOCK_THREAD_CPUTIME_ID)
+
+Time Time::threadCpuTime() {
+    return Time::ZERO;
+}
+
+#else
+
+Time Time::threadCpuTime() {
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return Time::fromMicros(time.tv_sec * 1000000 + time.tv_nsec / 1000);
+}
+
+#endif
+
 #ifndef _WIN32
 Time Time::sleep() const {
     timespec request, remaining;
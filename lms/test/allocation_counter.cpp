@@ -0,0 +1,22 @@
+#include "allocation_counter.h"
+
+namespace lmstest {
+
+namespace {
+
+char* volatile escape;
+
+}  // namespace
+
+bool countsAllocations() {
+    using lms::internal::AllocationTracker;
+
+    AllocationTracker::Counters counters;
+    AllocationTracker::Counters *previous = AllocationTracker::attach(&counters);
+    escape = new char;
+    delete escape;
+    AllocationTracker::attach(previous);
+    return counters.allocations > 0;
+}
+
+}  // namespace lmstest
@@ -0,0 +1,16 @@
+#ifndef LMS_TEST_ALLOCATION_COUNTER_H
+#define LMS_TEST_ALLOCATION_COUNTER_H
+
+#include "lms/internal/allocation_tracker.h"
+
+namespace lmstest {
+
+/**
+ * @brief Check if allocations of the calling thread are counted, i.e.
+ * either liblmscore or the test executable replaced operator new.
+ */
+bool countsAllocations();
+
+}  // namespace lmstest
+
+#endif // LMS_TEST_ALLOCATION_COUNTER_H
@@ -0,0 +1,90 @@
+#include <cstdlib>
+#include <new>
+
+#include "lms/internal/allocation_tracker.h"
+
+/*
+ * Count allocations in the test executable even if liblmscore was built
+ * without LMS_ALLOCATION_TRACKING. The operators of the executable take
+ * precedence over those of shared libraries, so this also covers
+ * allocations inside liblmscore.
+ */
+
+namespace {
+
+void* allocate(std::size_t size) {
+    lms::internal::AllocationTracker::allocated(size);
+
+    if(size == 0) {
+        size = 1;
+    }
+
+    void *ptr;
+    while((ptr = std::malloc(size)) == nullptr) {
+        std::new_handler handler = std::get_new_handler();
+        if(handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+    return ptr;
+}
+
+void* allocateNothrow(std::size_t size) noexcept {
+    try {
+        return allocate(size);
+    } catch(std::bad_alloc const&) {
+        return nullptr;
+    }
+}
+
+void deallocate(void *ptr) noexcept {
+    if(ptr != nullptr) {
+        lms::internal::AllocationTracker::freed();
+        std::free(ptr);
+    }
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, std::nothrow_t const&) noexcept {
+    return allocateNothrow(size);
+}
+
+void* operator new[](std::size_t size, std::nothrow_t const&) noexcept {
+    return allocateNothrow(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::nothrow_t const&) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::nothrow_t const&) noexcept {
+    deallocate(ptr);
+}
+
+#if defined(__cpp_sized_deallocation)
+void operator delete(void *ptr, std::size_t) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+    deallocate(ptr);
+}
+#endif
@@ -0,0 +1,80 @@
+#include <vector>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "lms/buffer_pool.h"
+
+using lms::BufferPool;
+using lms::PooledBuffer;
+
+TEST(BufferPool, recycle) {
+    BufferPool<std::vector<int>> pool(2, [] (std::vector<int> &v) {
+        v.reserve(100);
+    });
+
+    EXPECT_EQ(2u, pool.size());
+    EXPECT_EQ(2u, pool.available());
+
+    PooledBuffer<std::vector<int>> a = pool.acquire();
+    ASSERT_TRUE(static_cast<bool>(a));
+    EXPECT_EQ(100u, a->capacity());
+    a->push_back(42);
+    std::vector<int> *data = a.get();
+    EXPECT_EQ(1u, pool.available());
+
+    {
+        PooledBuffer<std::vector<int>> copy = a;
+        EXPECT_EQ(2, a.useCount());
+        a.reset();
+        // still referenced by the copy
+        EXPECT_EQ(1u, pool.available());
+    }
+
+    EXPECT_EQ(2u, pool.available());
+
+    // the same buffers are handed out again, contents are kept
+    PooledBuffer<std::vector<int>> b = pool.acquire();
+    PooledBuffer<std::vector<int>> c = pool.acquire();
+    EXPECT_TRUE(b.get() == data || c.get() == data);
+    EXPECT_EQ(0u, pool.overflows());
+}
+
+TEST(BufferPool, overflow) {
+    BufferPool<int> pool(1);
+
+    PooledBuffer<int> a = pool.acquire();
+    PooledBuffer<int> b = pool.acquire();
+    ASSERT_TRUE(static_cast<bool>(b));
+    EXPECT_NE(a.get(), b.get());
+    EXPECT_EQ(1u, pool.overflows());
+
+    b.reset();
+    a.reset();
+    EXPECT_EQ(1u, pool.available());
+}
+
+TEST(BufferPool, outlivePool) {
+    PooledBuffer<int> a;
+
+    {
+        BufferPool<int> pool(1);
+        a = pool.acquire();
+        *a = 5;
+    }
+
+    EXPECT_EQ(5, *a);
+    a.reset();
+}
+
+TEST(BufferPool, move) {
+    BufferPool<int> pool(1);
+
+    PooledBuffer<int> a = pool.acquire();
+    PooledBuffer<int> b(std::move(a));
+    EXPECT_FALSE(static_cast<bool>(a));
+    EXPECT_EQ(1, b.useCount());
+
+    a = std::move(b);
+    EXPECT_EQ(1, a.useCount());
+    EXPECT_EQ(0u, pool.available());
+}
@@ -0,0 +1,200 @@
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "lms/data_channel.h"
+#include "lms/module.h"
+#include "runtime_fixture.h"
+
+using lms::internal::DataChannelInternal;
+using lms::internal::Object;
+using lms::internal::ObjectPtr;
+
+namespace {
+
+std::shared_ptr<DataChannelInternal> makeChannel(const int *cycle) {
+    std::shared_ptr<DataChannelInternal> channel = std::make_shared<DataChannelInternal>();
+    channel->main = ObjectPtr(new Object<int>());
+    channel->cycleCounter = cycle;
+    return channel;
+}
+
+class PoseWriter : public lms::Module {
+public:
+    bool initialize() override {
+        pose = writeChannel<int>("POSE");
+        return true;
+    }
+
+    bool cycle() override {
+        *pose = cycleCounter() + 1;
+        return true;
+    }
+
+    bool deinitialize() override {
+        return true;
+    }
+
+    lms::WriteDataChannel<int> pose;
+};
+
+class PoseReader : public lms::Module {
+public:
+    PoseReader() : seen(-1) {}
+
+    bool initialize() override {
+        pose = readChannel<int>("POSE");
+        return true;
+    }
+
+    bool cycle() override {
+        seen = *pose;
+        return true;
+    }
+
+    bool deinitialize() override {
+        return true;
+    }
+
+    lms::ReadDataChannel<int> pose;
+    int seen;
+};
+
+}  // namespace
+
+TEST(DataChannel, stampWrite) {
+    int cycle = 0;
+    std::shared_ptr<DataChannelInternal> channel = makeChannel(&cycle);
+
+    lms::WriteDataChannel<int> writer(channel);
+    lms::ReadDataChannel<int> reader(channel);
+
+    EXPECT_EQ(-1, reader.lastWriteCycle());
+    EXPECT_FALSE(reader.changedSince(-1));
+
+    // reading does not count as write access
+    EXPECT_EQ(0, *reader);
+    EXPECT_EQ(-1, reader.lastWriteCycle());
+
+    *writer = 5;
+    EXPECT_EQ(0, reader.lastWriteCycle());
+    EXPECT_TRUE(reader.changedSince(-1));
+    EXPECT_FALSE(reader.changedSince(0));
+
+    lms::Time firstWrite = reader.lastWriteTime();
+    EXPECT_NE(lms::Time::ZERO, firstWrite);
+
+    // only the first write access in a cycle takes the time
+    *writer = 6;
+    EXPECT_EQ(firstWrite, reader.lastWriteTime());
+
+    cycle = 3;
+    EXPECT_FALSE(reader.changedSince(0));
+    *writer.get() = 7;
+    EXPECT_EQ(3, reader.lastWriteCycle());
+    EXPECT_TRUE(reader.changedSince(2));
+    EXPECT_FALSE(reader.changedSince(3));
+}
+
+TEST(DataChannel, readersAndWriters) {
+    using lms::internal::ModuleWrapper;
+
+    std::shared_ptr<ModuleWrapper> a = std::make_shared<ModuleWrapper>(nullptr);
+    std::shared_ptr<ModuleWrapper> b = std::make_shared<ModuleWrapper>(nullptr);
+    DataChannelInternal channel;
+
+    channel.addWriter(a);
+    channel.addReader(b);
+    channel.addReader(b);
+
+    EXPECT_TRUE(channel.isWriter(a));
+    EXPECT_FALSE(channel.isReader(a));
+    EXPECT_TRUE(channel.isReader(b));
+    EXPECT_EQ(1u, channel.readers.size());
+
+    EXPECT_FALSE(channel.removeModule(a));
+    EXPECT_FALSE(channel.isReaderOrWriter(a));
+    EXPECT_TRUE(channel.writers.empty());
+
+    EXPECT_TRUE(channel.removeModule(b));
+    EXPECT_TRUE(channel.readers.empty());
+}
+
+TEST(DataChannel, stats) {
+    using lms::internal::ChannelStats;
+
+    int cycle = 0;
+    std::shared_ptr<DataChannelInternal> channel = makeChannel(&cycle);
+
+    lms::WriteDataChannel<int> writer(channel);
+    lms::ReadDataChannel<int> reader(channel);
+
+    // no counting without stats
+    *writer = 1;
+    EXPECT_EQ(1, *reader);
+
+    channel->stats.reset(new ChannelStats(7));
+    EXPECT_EQ(7u, channel->stats->label());
+
+    *writer = 2;
+    *writer.get() = 3;
+    EXPECT_EQ(3, *reader);
+    channel->stats->addBlocked(40);
+
+    ChannelStats::Values values = channel->stats->collect(4);
+    EXPECT_EQ(1u, values.reads);
+    EXPECT_EQ(2u, values.writes);
+    EXPECT_EQ(4u, values.bytes);
+    EXPECT_EQ(40, values.blockedMicros);
+
+    // counters start from zero in each cycle
+    EXPECT_EQ(3, *reader);
+    values = channel->stats->collect(0);
+    EXPECT_EQ(1u, values.reads);
+    EXPECT_EQ(0u, values.writes);
+
+    EXPECT_EQ(2u, channel->stats->cycles());
+    EXPECT_EQ(2u, channel->stats->total().reads);
+    EXPECT_EQ(4u, channel->stats->total().bytes);
+
+    // serialized sizes are measured every SIZE_INTERVAL cycles
+    EXPECT_TRUE(channel->stats->sizeOutdated(0));
+    channel->stats->size(5, 100);
+    EXPECT_FALSE(channel->stats->sizeOutdated(5 + ChannelStats::SIZE_INTERVAL - 1));
+    EXPECT_TRUE(channel->stats->sizeOutdated(5 + ChannelStats::SIZE_INTERVAL));
+    EXPECT_EQ(100u, channel->stats->size());
+}
+
+typedef RuntimeFixture DataChannelRuntime;
+
+TEST_F(DataChannelRuntime, importFromRuntime) {
+    Runtime &producer = runtime("default");
+    Runtime &consumer = runtime("perception");
+    addModule<PoseWriter>(producer, "writer");
+    PoseReader *reader = addModule<PoseReader>(consumer, "reader",
+        [](ModuleWrapper &wrapper) {
+            wrapper.channelRuntimes["POSE"] = "default";
+        });
+
+    // nothing was published yet
+    EXPECT_TRUE(consumer.cycle());
+    EXPECT_EQ(0, reader->seen);
+
+    // afterCycle() of the producer publishes, beforeCycle() of the
+    // consumer imports
+    EXPECT_TRUE(producer.cycle());
+    EXPECT_TRUE(consumer.cycle());
+    EXPECT_EQ(1, reader->seen);
+
+    // only the latest value is handed over
+    EXPECT_TRUE(producer.cycle());
+    EXPECT_TRUE(producer.cycle());
+    EXPECT_TRUE(consumer.cycle());
+    EXPECT_EQ(3, reader->seen);
+
+    // the consumer's copy stays stable while the producer writes
+    EXPECT_TRUE(producer.cycle());
+    EXPECT_EQ(3, *reader->pose);
+
+    EXPECT_TRUE(consumer.cycle());
+    EXPECT_EQ(4, reader->seen);
+}
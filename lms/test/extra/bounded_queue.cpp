@@ -0,0 +1,97 @@
+#include <thread>
+#include <vector>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "lms/extra/bounded_queue.h"
+
+using lms::extra::BoundedQueue;
+
+TEST(BoundedQueue, capacity) {
+    EXPECT_EQ(2u, BoundedQueue<int>(0).capacity());
+    EXPECT_EQ(8u, BoundedQueue<int>(8).capacity());
+    EXPECT_EQ(16u, BoundedQueue<int>(9).capacity());
+}
+
+TEST(BoundedQueue, pushAndPop) {
+    BoundedQueue<std::string> queue(4);
+    std::string item;
+
+    EXPECT_FALSE(queue.pop(item));
+
+    EXPECT_TRUE(queue.push("a"));
+    EXPECT_TRUE(queue.push("b"));
+    EXPECT_TRUE(queue.push("c"));
+    EXPECT_TRUE(queue.push("d"));
+    EXPECT_FALSE(queue.push("e"));
+    EXPECT_EQ(4u, queue.sizeApprox());
+
+    ASSERT_TRUE(queue.pop(item));
+    EXPECT_EQ("a", item);
+
+    // freed slot can be reused
+    EXPECT_TRUE(queue.push("e"));
+
+    std::vector<std::string> items;
+    EXPECT_EQ(2u, queue.popAll(items, 2));
+    EXPECT_EQ(std::vector<std::string>({"b", "c"}), items);
+
+    EXPECT_EQ(2u, queue.popAll(items));
+    EXPECT_EQ(std::vector<std::string>({"b", "c", "d", "e"}), items);
+    EXPECT_FALSE(queue.pop(item));
+}
+
+TEST(BoundedQueue, singleProducer) {
+    BoundedQueue<int> queue(8);
+    queue.singleProducer(true);
+
+    for(int round = 0; round < 3; round++) {
+        for(int i = 0; i < 8; i++) {
+            EXPECT_TRUE(queue.push(i));
+        }
+        EXPECT_FALSE(queue.push(8));
+
+        int item;
+        for(int i = 0; i < 8; i++) {
+            ASSERT_TRUE(queue.pop(item));
+            EXPECT_EQ(i, item);
+        }
+    }
+}
+
+TEST(BoundedQueue, multiProducer) {
+    const int PRODUCERS = 4;
+    const int ITEMS = 2000;
+
+    BoundedQueue<int> queue(64);
+    std::vector<std::thread> producers;
+
+    for(int p = 0; p < PRODUCERS; p++) {
+        producers.push_back(std::thread([&queue, p, ITEMS] () {
+            for(int i = 0; i < ITEMS; i++) {
+                while(! queue.push(p * ITEMS + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        }));
+    }
+
+    // items of each producer arrive in order
+    std::vector<int> next(PRODUCERS, 0);
+    int received = 0;
+    int item;
+    while(received < PRODUCERS * ITEMS) {
+        if(queue.pop(item)) {
+            int p = item / ITEMS;
+            ASSERT_EQ(next[p], item % ITEMS);
+            next[p]++;
+            received++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    for(std::thread &t : producers) {
+        t.join();
+    }
+}
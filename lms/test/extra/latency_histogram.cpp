@@ -0,0 +1,65 @@
+#include "gtest/gtest.h"
+#include "lms/extra/latency_histogram.h"
+
+using lms::extra::LatencyHistogram;
+
+TEST(LatencyHistogram, empty) {
+    LatencyHistogram hist;
+
+    EXPECT_EQ(0u, hist.count());
+    EXPECT_EQ(0, hist.min());
+    EXPECT_EQ(0, hist.max());
+    EXPECT_EQ(0, hist.percentile(0.5));
+}
+
+TEST(LatencyHistogram, smallValuesAreExact) {
+    LatencyHistogram hist;
+
+    for(int i = 1; i <= 10; i++) {
+        hist.record(i);
+    }
+
+    EXPECT_EQ(10u, hist.count());
+    EXPECT_EQ(1, hist.min());
+    EXPECT_EQ(10, hist.max());
+    EXPECT_DOUBLE_EQ(5.5, hist.mean());
+    EXPECT_EQ(5, hist.percentile(0.5));
+    EXPECT_EQ(9, hist.percentile(0.9));
+    EXPECT_EQ(10, hist.percentile(1.0));
+}
+
+TEST(LatencyHistogram, relativeError) {
+    LatencyHistogram hist;
+
+    for(int i = 0; i < 1000; i++) {
+        hist.record(1000 + i);
+    }
+    hist.record(-5);
+
+    EXPECT_EQ(0, hist.min());
+    EXPECT_EQ(1999, hist.max());
+
+    std::int64_t median = hist.percentile(0.5);
+    EXPECT_GE(median, 1500);
+    EXPECT_LE(median, 1500 * 9 / 8);
+
+    std::int64_t p99 = hist.percentile(0.99);
+    EXPECT_GE(p99, 1990);
+    EXPECT_LE(p99, 1999);
+}
+
+TEST(LatencyHistogram, merge) {
+    LatencyHistogram a, b;
+
+    a.record(100);
+    b.record(5);
+    b.record(1000000);
+    a.merge(b);
+
+    EXPECT_EQ(3u, a.count());
+    EXPECT_EQ(5, a.min());
+    EXPECT_EQ(1000000, a.max());
+
+    a.reset();
+    EXPECT_EQ(0u, a.count());
+}
@@ -115,3 +115,11 @@ TEST(string, lenOf) {
     ASSERT_EQ(size_t(4), lenOf("test"));
     ASSERT_EQ(size_t(0), lenOf(""));
 }
+
+TEST(string, stableHash) {
+    using lms::extra::stableHash;
+
+    ASSERT_EQ(0xcbf29ce484222325ULL, stableHash(""));
+    ASSERT_EQ(0xaf63dc4c8601ec8cULL, stableHash("a"));
+    ASSERT_NE(stableHash("POSE"), stableHash("IMAGE"));
+}
@@ -0,0 +1,36 @@
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lms/internal/allocation_tracker.h"
+#include "../allocation_counter.h"
+
+using lms::internal::AllocationTracker;
+
+namespace {
+
+std::vector<char>* volatile escape;
+
+}  // namespace
+
+TEST(AllocationTracker, countsAttachedThread) {
+    if(! lmstest::countsAllocations()) {
+        GTEST_SKIP() << "operator new is not replaced";
+    }
+
+    AllocationTracker::Counters counters;
+    EXPECT_EQ(nullptr, AllocationTracker::attach(&counters));
+
+    // the vector object and its buffer
+    escape = new std::vector<char>(1000);
+    delete escape;
+
+    EXPECT_EQ(&counters, AllocationTracker::attach(nullptr));
+    EXPECT_EQ(2u, counters.allocations);
+    EXPECT_GE(counters.bytes, 1000u);
+    EXPECT_EQ(2u, counters.frees);
+
+    // nothing is counted without attached counters
+    escape = new std::vector<char>(1000);
+    delete escape;
+    EXPECT_EQ(2u, counters.allocations);
+}
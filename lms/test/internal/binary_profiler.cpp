@@ -0,0 +1,84 @@
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <map>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#include "lms/internal/binary_profiler.h"
+
+using lms::internal::BinaryProfiler;
+using lms::internal::BinaryProfileReader;
+using lms::internal::Profiler;
+
+TEST(BinaryProfiler, writeAndRead) {
+    std::string file = "/tmp/lmstest_profile_" + std::to_string(getpid());
+
+    {
+        BinaryProfiler profiler(file);
+        profiler.onLabel(0, "default.a");
+        profiler.onLabel(1, "default.b");
+        profiler.onLabel(2, "default.CH");
+        profiler.onLabel(3, "default.a.allocations");
+
+        Profiler::currentCycle(7);
+        profiler.onMarker(Profiler::BEGIN, lms::Time::fromMicros(100), 0, "default.a");
+        profiler.onCounter(lms::Time::fromMicros(150), 3, "default.a.allocations", -5);
+        profiler.onMarker(Profiler::END, lms::Time::fromMicros(150), 0, "default.a");
+
+        std::thread worker([&profiler]() {
+            Profiler::currentCycle(7);
+            profiler.onMarker(Profiler::BEGIN, lms::Time::fromMicros(110), 1, "default.b");
+            profiler.onMarker(Profiler::END, lms::Time::fromMicros(130), 1, "default.b");
+        });
+        worker.join();
+
+        lms::internal::ChannelStats::Values values;
+        values.reads = 3;
+        values.writes = 1;
+        profiler.onChannelStats(lms::Time::fromMicros(200), 2, "default.CH", values);
+
+        EXPECT_EQ(0u, profiler.dropped());
+    }
+
+    BinaryProfileReader reader;
+    ASSERT_TRUE(reader.open(file));
+
+    std::map<std::string, int> markers;
+    BinaryProfileReader::Entry entry;
+    int stats = 0;
+    int counters = 0;
+    while(reader.next(entry)) {
+        std::string label = reader.label(entry.label);
+        if(entry.type == Profiler::CHANNEL_STATS) {
+            stats++;
+            EXPECT_EQ("default.CH", label);
+            EXPECT_EQ(3u, entry.values.reads);
+            EXPECT_EQ(1u, entry.values.writes);
+            continue;
+        }
+        if(entry.type == Profiler::COUNTER) {
+            counters++;
+            EXPECT_EQ("default.a.allocations", label);
+            EXPECT_EQ(-5, entry.value);
+            EXPECT_EQ(7, entry.cycle);
+            EXPECT_EQ(0u, entry.thread);
+            continue;
+        }
+
+        markers[label]++;
+        EXPECT_EQ(7, entry.cycle);
+        EXPECT_EQ(label == "default.a" ? 0u : 1u, entry.thread);
+        if(label == "default.b" && entry.type == Profiler::END) {
+            EXPECT_EQ(130, entry.time.micros());
+        }
+    }
+
+    EXPECT_EQ(1, stats);
+    EXPECT_EQ(1, counters);
+    EXPECT_EQ(2, markers["default.a"]);
+    EXPECT_EQ(2, markers["default.b"]);
+
+    std::remove(file.c_str());
+}
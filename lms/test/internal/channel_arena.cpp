@@ -0,0 +1,79 @@
+#include <cstdint>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "lms/internal/channel_arena.h"
+#include "lms/internal/data_channel_internal.h"
+
+using lms::internal::ChannelArena;
+using lms::internal::Object;
+using lms::internal::ObjectDeleter;
+using lms::internal::ObjectPtr;
+
+TEST(ChannelArena, cacheLineAligned) {
+    ChannelArena arena;
+
+    void *a = arena.allocate(8, alignof(double));
+    void *b = arena.allocate(100, alignof(double));
+    void *c = arena.allocate(1, 1);
+    ASSERT_NE(nullptr, a);
+    ASSERT_NE(nullptr, b);
+    ASSERT_NE(nullptr, c);
+
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a) % ChannelArena::CACHE_LINE);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(b) % ChannelArena::CACHE_LINE);
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(c) % ChannelArena::CACHE_LINE);
+
+    // contiguous and padded
+    EXPECT_EQ(static_cast<char*>(a) + 64, b);
+    EXPECT_EQ(static_cast<char*>(b) + 128, c);
+    EXPECT_EQ(64u + 128u + 64u, arena.bytesUsed());
+    EXPECT_EQ(1u, arena.chunkCount());
+
+    std::size_t chunk, offset;
+    ASSERT_TRUE(arena.locate(b, chunk, offset));
+    EXPECT_EQ(0u, chunk);
+    EXPECT_EQ(64u, offset);
+
+    int stackValue;
+    EXPECT_FALSE(arena.locate(&stackValue, chunk, offset));
+}
+
+TEST(ChannelArena, reuseFreedMemory) {
+    ChannelArena arena;
+
+    void *a = arena.allocate(40, 8);
+    arena.deallocate(a, 40);
+    EXPECT_EQ(0u, arena.bytesUsed());
+
+    // same padded size
+    EXPECT_EQ(a, arena.allocate(64, 8));
+    EXPECT_NE(a, arena.allocate(64, 8));
+}
+
+TEST(ChannelArena, largeAllocation) {
+    ChannelArena arena;
+
+    void *small = arena.allocate(8, 8);
+    void *large = arena.allocate(2 * ChannelArena::CHUNK_SIZE, 8);
+    ASSERT_NE(nullptr, small);
+    ASSERT_NE(nullptr, large);
+    EXPECT_EQ(2u, arena.chunkCount());
+    EXPECT_GE(arena.bytesMapped(), 3 * ChannelArena::CHUNK_SIZE);
+}
+
+TEST(ChannelArena, unsupportedAlignment) {
+    ChannelArena arena;
+    EXPECT_EQ(nullptr, arena.allocate(8, 2 * ChannelArena::CACHE_LINE));
+}
+
+TEST(ChannelArena, objectDeleter) {
+    std::shared_ptr<ChannelArena> arena = std::make_shared<ChannelArena>();
+
+    void *mem = arena->allocate(sizeof(Object<int>), alignof(Object<int>));
+    ObjectPtr obj(new (mem) Object<int>(), ObjectDeleter(arena, sizeof(Object<int>)));
+    EXPECT_EQ(ChannelArena::paddedSize(sizeof(Object<int>)), arena->bytesUsed());
+
+    obj.reset();
+    EXPECT_EQ(0u, arena->bytesUsed());
+}
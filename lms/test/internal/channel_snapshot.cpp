@@ -0,0 +1,66 @@
+#include <string>
+
+#include "gtest/gtest.h"
+#include "lms/internal/channel_snapshot.h"
+
+using lms::internal::ChannelSnapshot;
+using lms::internal::Object;
+
+TEST(ChannelSnapshot, noSnapshot) {
+    ChannelSnapshot snapshot;
+    EXPECT_FALSE(snapshot.update());
+}
+
+TEST(ChannelSnapshot, publishAndUpdate) {
+    ChannelSnapshot snapshot;
+    Object<int> producer;
+    Object<int> consumer;
+
+    producer.value = 42;
+    EXPECT_TRUE(snapshot.publish(producer));
+    producer.value = 43;
+
+    ASSERT_TRUE(snapshot.update());
+    EXPECT_TRUE(consumer.copyFrom(snapshot.front()));
+    EXPECT_EQ(42, consumer.value);
+
+    // nothing new was published
+    EXPECT_FALSE(snapshot.update());
+}
+
+TEST(ChannelSnapshot, latestWins) {
+    ChannelSnapshot snapshot;
+    Object<std::string> producer;
+
+    for(int i = 0; i < 5; i++) {
+        producer.value = std::to_string(i);
+        EXPECT_TRUE(snapshot.publish(producer));
+    }
+
+    ASSERT_TRUE(snapshot.update());
+    EXPECT_EQ("4", static_cast<const Object<std::string>&>(snapshot.front()).value);
+}
+
+TEST(ChannelSnapshot, typeMismatch) {
+    Object<int> a;
+    Object<float> b;
+    EXPECT_FALSE(a.copyFrom(b));
+}
+
+TEST(ChannelSnapshot, provenance) {
+    using lms::internal::Provenance;
+
+    ChannelSnapshot snapshot;
+    Object<int> producer;
+
+    Provenance provenance;
+    provenance.origin = lms::Time::fromMicros(1234);
+    provenance.source = 7;
+
+    EXPECT_TRUE(snapshot.publish(producer, provenance));
+    provenance.origin = lms::Time::fromMicros(5678);
+
+    ASSERT_TRUE(snapshot.update());
+    EXPECT_EQ(lms::Time::fromMicros(1234), snapshot.frontProvenance().origin);
+    EXPECT_EQ(7u, snapshot.frontProvenance().source);
+}
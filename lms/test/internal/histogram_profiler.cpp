@@ -0,0 +1,68 @@
+#include "gtest/gtest.h"
+#include "lms/internal/histogram_profiler.h"
+
+using lms::Time;
+using lms::extra::LatencyHistogram;
+using lms::internal::HistogramProfiler;
+using lms::internal::Profiler;
+
+TEST(HistogramProfiler, slidingWindow) {
+    Time start = Time::now();
+    HistogramProfiler profiler(Time::fromMillis(100), 2);
+    profiler.onLabel(0, "default.camera");
+
+    // 10 us in the first window, 30 us in the second one
+    profiler.onMarker(Profiler::BEGIN, start, 0, "default.camera");
+    profiler.onMarker(Profiler::END, start + Time::fromMicros(10), 0, "default.camera");
+    profiler.onMarker(Profiler::BEGIN, start + Time::fromMillis(150), 0, "default.camera");
+    profiler.onMarker(Profiler::END, start + Time::fromMillis(150) + Time::fromMicros(30),
+                      0, "default.camera");
+
+    LatencyHistogram hist;
+    ASSERT_TRUE(profiler.recent("default.camera", hist));
+    EXPECT_EQ(2u, hist.count());
+    EXPECT_EQ(10, hist.min());
+    EXPECT_EQ(30, hist.max());
+
+    // the first window falls out of the sliding window
+    profiler.onMarker(Profiler::BEGIN, start + Time::fromMillis(250), 0, "default.camera");
+    profiler.onMarker(Profiler::END, start + Time::fromMillis(250) + Time::fromMicros(20),
+                      0, "default.camera");
+
+    ASSERT_TRUE(profiler.recent("default.camera", hist));
+    EXPECT_EQ(2u, hist.count());
+    EXPECT_EQ(20, hist.min());
+
+    ASSERT_TRUE(profiler.total("default.camera", hist));
+    EXPECT_EQ(3u, hist.count());
+
+    EXPECT_FALSE(profiler.recent("default.unknown", hist));
+}
+
+TEST(HistogramProfiler, perfCounters) {
+    lms::internal::PerfCounters perf;
+    if(! perf.open()) {
+        // not allowed in this environment, nothing to check
+        EXPECT_FALSE(perf.error().empty());
+        return;
+    }
+
+    HistogramProfiler profiler;
+    profiler.perfCounters(true);
+    profiler.onLabel(0, "default.camera");
+
+    profiler.onMarker(Profiler::BEGIN, Time::now(), 0, "default.camera");
+    volatile int sum = 0;
+    for(int i = 0; i < 100000; i++) {
+        sum += i;
+    }
+    profiler.onMarker(Profiler::END, Time::now(), 0, "default.camera");
+
+    lms::internal::PerfCounters::Values values;
+    std::uint64_t samples;
+    ASSERT_TRUE(profiler.counters("default.camera", values, samples));
+    EXPECT_EQ(1u, samples);
+    if(perf.has(lms::internal::PerfCounters::INSTRUCTIONS)) {
+        EXPECT_GT(values.value[lms::internal::PerfCounters::INSTRUCTIONS], 100000u);
+    }
+}
@@ -0,0 +1,87 @@
+#include <sstream>
+
+#include "gtest/gtest.h"
+#include "lms/internal/profile_analyzer.h"
+
+using lms::Time;
+using lms::internal::Profiler;
+using lms::internal::ProfileAnalyzer;
+
+TEST(ProfileAnalyzer, csv) {
+    // two cycles of a runtime with modules a and b
+    std::istringstream csv(
+        "2,0,default\n"
+        "2,1,default.a\n"
+        "2,2,default.b\n"
+        "2,3,default.cycle time (us)\n"
+        "0,0,100\n" "0,1,0\n" "1,1,10\n" "0,2,5\n" "1,2,20\n" "1,0,5\n" "4,3,40\n"
+        "0,0,60\n" "0,1,0\n" "1,1,30\n" "0,2,0\n" "1,2,20\n" "1,0,0\n" "4,3,50\n");
+
+    ProfileAnalyzer profile;
+    ASSERT_TRUE(profile.loadCsv(csv));
+
+    ASSERT_EQ(2u, profile.cycles().size());
+    EXPECT_EQ(Time::fromMicros(100), profile.cycles()[0].begin);
+    EXPECT_EQ(Time::fromMicros(140), profile.cycles()[0].end);
+
+    auto const& labels = profile.labels();
+    ASSERT_EQ(1u, labels.count("default.a"));
+    EXPECT_EQ(2u, labels.at("default.a").hist.count());
+    EXPECT_EQ(Time::fromMicros(40), labels.at("default.a").total);
+    EXPECT_EQ(2u, labels.at("default.b").critical);
+
+    // the gap of 5 us between a and b in the first cycle
+    ASSERT_EQ(1u, profile.threads().size());
+    EXPECT_EQ(1u, profile.threads()[0].gaps);
+    EXPECT_EQ(Time::fromMicros(5), profile.threads()[0].idle);
+    EXPECT_EQ(Time::fromMicros(80), profile.threads()[0].busy);
+
+    auto const& counters = profile.counters();
+    ASSERT_EQ(1u, counters.count("default.cycle time (us)"));
+    EXPECT_EQ(2u, counters.at("default.cycle time (us)").count);
+    EXPECT_EQ(90, counters.at("default.cycle time (us)").sum);
+    EXPECT_EQ(40, counters.at("default.cycle time (us)").min);
+    EXPECT_EQ(50, counters.at("default.cycle time (us)").max);
+}
+
+TEST(ProfileAnalyzer, criticalPath) {
+    ProfileAnalyzer profile;
+    profile.label(0, "default");
+    profile.label(1, "default.camera");
+    profile.label(2, "default.lidar");
+    profile.label(3, "default.fusion");
+
+    // camera and lidar in parallel, fusion waits for the slower lidar
+    profile.marker(Profiler::BEGIN, Time::fromMicros(0), 0, 0);
+    profile.marker(Profiler::BEGIN, Time::fromMicros(0), 1, 0);
+    profile.marker(Profiler::END, Time::fromMicros(10), 1, 0);
+    profile.marker(Profiler::BEGIN, Time::fromMicros(30), 3, 0);
+    profile.marker(Profiler::END, Time::fromMicros(40), 3, 0);
+    profile.marker(Profiler::END, Time::fromMicros(40), 0, 0);
+    profile.marker(Profiler::BEGIN, Time::fromMicros(0), 2, 1);
+    profile.marker(Profiler::END, Time::fromMicros(30), 2, 1);
+    profile.analyze();
+
+    std::vector<ProfileAnalyzer::Interval> path = profile.criticalPath(0);
+    ASSERT_EQ(2u, path.size());
+    EXPECT_EQ("default.lidar", profile.labelName(path[0].label));
+    EXPECT_EQ("default.fusion", profile.labelName(path[1].label));
+
+    ASSERT_EQ(2u, profile.threads().size());
+    EXPECT_EQ(1u, profile.threads()[0].gaps);
+    EXPECT_EQ(Time::fromMicros(20), profile.threads()[0].maxGap);
+
+    // the same profile with a slower fusion
+    ProfileAnalyzer slower;
+    slower.label(0, "default");
+    slower.label(3, "default.fusion");
+    slower.marker(Profiler::BEGIN, Time::fromMicros(0), 0, 0);
+    slower.marker(Profiler::BEGIN, Time::fromMicros(0), 3, 0);
+    slower.marker(Profiler::END, Time::fromMicros(20), 3, 0);
+    slower.marker(Profiler::END, Time::fromMicros(20), 0, 0);
+    slower.analyze();
+
+    std::ostringstream report;
+    EXPECT_EQ(1, ProfileAnalyzer::compare(profile, slower, 0.1, report));
+    EXPECT_NE(std::string::npos, report.str().find("REGRESSION"));
+}
@@ -0,0 +1,95 @@
+#include <map>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "lms/internal/profiler.h"
+
+using lms::internal::Profiler;
+
+namespace {
+
+struct RecordingListener : public Profiler::ProfilingListener {
+    std::map<Profiler::LabelId, std::string> &labels;
+    int &markers;
+
+    RecordingListener(std::map<Profiler::LabelId, std::string> &labels, int &markers)
+        : labels(labels), markers(markers) {}
+
+    void onLabel(Profiler::LabelId id, std::string const& label) override {
+        labels[id] = label;
+    }
+
+    void onMarker(Profiler::Type, lms::Time, Profiler::LabelId id,
+                  std::string const& label) override {
+        EXPECT_EQ(labels[id], label);
+        markers++;
+    }
+};
+
+}  // namespace
+
+TEST(Profiler, labels) {
+    Profiler profiler;
+
+    Profiler::LabelId a = profiler.label("default.a");
+    EXPECT_EQ(a, profiler.label("default.a"));
+    EXPECT_EQ("default.a", profiler.labelName(a));
+
+    // without listeners marking is a no-op
+    profiler.markBegin(a);
+
+    std::map<Profiler::LabelId, std::string> labels;
+    int markers = 0;
+    profiler.appendListener(new RecordingListener(labels, markers));
+
+    // labels that were registered before are replayed
+    EXPECT_EQ("default.a", labels[a]);
+
+    profiler.markBegin(a);
+    profiler.markEnd("default.b");
+    EXPECT_EQ(2, markers);
+    EXPECT_EQ("default.b", labels[profiler.label("default.b")]);
+}
+
+TEST(Profiler, levels) {
+    Profiler profiler;
+    std::map<Profiler::LabelId, std::string> labels;
+    int markers = 0;
+    profiler.appendListener(new RecordingListener(labels, markers));
+    Profiler::LabelId cycle = profiler.label("default");
+    Profiler::LabelId module = profiler.label("default.a");
+
+    // the level is applied only at the next cycle boundary
+    profiler.level(Profiler::Level::OFF);
+    EXPECT_TRUE(profiler.enabled());
+    EXPECT_EQ(Profiler::Level::OFF, profiler.level());
+    profiler.applyLevel();
+    EXPECT_FALSE(profiler.enabled());
+    profiler.markBegin(cycle, Profiler::CYCLE);
+    profiler.markBegin(module);
+    EXPECT_EQ(0, markers);
+
+    profiler.level(Profiler::Level::CYCLES);
+    profiler.applyLevel();
+    profiler.markBegin(cycle, Profiler::CYCLE);
+    profiler.markBegin(module);
+    EXPECT_EQ(1, markers);
+
+    // only cycles 0, 4, 8 are reported
+    profiler.level(Profiler::Level::SAMPLED);
+    profiler.sampleInterval(4);
+    profiler.applyLevel();
+    markers = 0;
+    for(int i = 0; i < 10; i++) {
+        Profiler::currentCycle(i);
+        profiler.markBegin(cycle, Profiler::CYCLE);
+        profiler.markBegin(module);
+    }
+    Profiler::currentCycle(-1);
+    EXPECT_EQ(6, markers);
+
+    Profiler::Level level;
+    EXPECT_TRUE(Profiler::levelFromName("full", level));
+    EXPECT_EQ(Profiler::Level::FULL, level);
+    EXPECT_FALSE(Profiler::levelFromName("verbose", level));
+}
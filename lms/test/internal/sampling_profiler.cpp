@@ -0,0 +1,65 @@
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "lms/internal/sampling_profiler.h"
+
+using lms::Time;
+using lms::internal::Profiler;
+using lms::internal::SamplingProfiler;
+
+namespace {
+
+volatile double sink;
+
+void burnCpu(Time duration) {
+    Time start = Time::now();
+    double x = 1;
+    while(Time::now() - start < duration) {
+        for(int i = 0; i < 1000; i++) {
+            x = x * 1.0000001 + 0.5;
+        }
+    }
+    sink = x;
+}
+
+}  // namespace
+
+TEST(SamplingProfiler, foldedStacks) {
+    SamplingProfiler profiler("", 1000);
+    profiler.onLabel(0, "default.camera");
+    ASSERT_TRUE(profiler.start());
+
+    profiler.onMarker(Profiler::BEGIN, Time::now(), 0, "default.camera");
+    burnCpu(Time::fromMillis(200));
+    profiler.onMarker(Profiler::END, Time::now(), 0, "default.camera");
+    profiler.stop();
+
+    EXPECT_GT(profiler.samples(), 0u);
+
+    std::ostringstream folded;
+    profiler.writeFolded(folded);
+    EXPECT_NE(std::string::npos, folded.str().find("default;camera;"));
+}
+
+TEST(SamplingProfiler, stopWhileSampling) {
+    // other threads keep receiving SIGPROF while profilers are destroyed
+    std::vector<std::thread> workers;
+    for(int i = 0; i < 4; i++) {
+        workers.emplace_back([]() {
+            burnCpu(Time::fromMillis(300));
+        });
+    }
+
+    for(int i = 0; i < 20; i++) {
+        std::unique_ptr<SamplingProfiler> profiler(new SamplingProfiler("", 10000));
+        EXPECT_TRUE(profiler->start());
+        burnCpu(Time::fromMillis(5));
+    }
+
+    for(std::thread &worker : workers) {
+        worker.join();
+    }
+}
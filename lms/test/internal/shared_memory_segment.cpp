@@ -0,0 +1,124 @@
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#include "lms/internal/shared_memory_segment.h"
+
+using lms::internal::SharedMemorySegment;
+
+namespace {
+
+struct Pose {
+    double x, y, phi;
+};
+
+/* large enough that concurrent copies are likely to overlap */
+struct Block {
+    std::uint64_t values[1024];
+};
+
+bool consistent(Block const& block) {
+    for(std::uint64_t value : block.values) {
+        if(value != block.values[0]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string segmentName(const std::string &test) {
+    return "/lmstest_" + test + "_" + std::to_string(getpid());
+}
+
+}  // namespace
+
+TEST(SharedMemorySegment, writeAndRead) {
+    std::string name = segmentName("writeAndRead");
+    std::uint64_t hash = SharedMemorySegment::hashTypeName("Pose");
+
+    SharedMemorySegment writer;
+    SharedMemorySegment reader;
+    ASSERT_TRUE(writer.open(name, sizeof(Pose), hash)) << writer.error();
+    ASSERT_TRUE(reader.open(name, sizeof(Pose), hash)) << reader.error();
+
+    Pose in = {1, 2, 3};
+    Pose out = {0, 0, 0};
+    std::uint64_t sequence = 0;
+
+    // nothing written yet
+    EXPECT_FALSE(reader.read(&out, sequence));
+
+    writer.write(&in);
+    ASSERT_TRUE(reader.read(&out, sequence));
+    EXPECT_EQ(1, out.x);
+    EXPECT_EQ(2, out.y);
+    EXPECT_EQ(3, out.phi);
+
+    // no new value
+    EXPECT_FALSE(reader.read(&out, sequence));
+
+    in.x = 4;
+    lms::internal::Provenance provenance;
+    provenance.origin = lms::Time::fromMicros(99);
+    provenance.source = 5;
+    writer.write(&in, provenance);
+
+    lms::internal::Provenance received;
+    ASSERT_TRUE(reader.read(&out, sequence, &received));
+    EXPECT_EQ(4, out.x);
+    EXPECT_EQ(lms::Time::fromMicros(99), received.origin);
+    EXPECT_EQ(5u, received.source);
+
+    shm_unlink(name.c_str());
+}
+
+TEST(SharedMemorySegment, typeMismatch) {
+    std::string name = segmentName("typeMismatch");
+
+    SharedMemorySegment writer;
+    SharedMemorySegment reader;
+    ASSERT_TRUE(writer.open(name, sizeof(Pose), SharedMemorySegment::hashTypeName("Pose")));
+    EXPECT_FALSE(reader.open(name, sizeof(Pose), SharedMemorySegment::hashTypeName("Twist")));
+    EXPECT_FALSE(reader.isOpen());
+    EXPECT_FALSE(reader.open(name, sizeof(int), SharedMemorySegment::hashTypeName("Pose")));
+
+    shm_unlink(name.c_str());
+}
+
+TEST(SharedMemorySegment, noTornReads) {
+    std::string name = segmentName("noTornReads");
+    std::uint64_t hash = SharedMemorySegment::hashTypeName("Block");
+
+    SharedMemorySegment writer;
+    SharedMemorySegment reader;
+    ASSERT_TRUE(writer.open(name, sizeof(Block), hash)) << writer.error();
+    ASSERT_TRUE(reader.open(name, sizeof(Block), hash)) << reader.error();
+
+    std::atomic<bool> running(true);
+    std::thread thread([&writer, &running]() {
+        Block in;
+        for(std::uint64_t i = 1; running.load(); i++) {
+            for(std::uint64_t &value : in.values) {
+                value = i;
+            }
+            writer.write(&in);
+        }
+    });
+
+    // the value is only touched by a successful read
+    Block out = Block();
+    for(int i = 0; i < 10000; i++) {
+        std::uint64_t sequence = 0;
+        reader.read(&out, sequence);
+        ASSERT_TRUE(consistent(out));
+    }
+
+    running.store(false);
+    thread.join();
+    shm_unlink(name.c_str());
+}
@@ -0,0 +1,72 @@
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lms/internal/telemetry.h"
+
+using lms::Time;
+using lms::internal::ChannelStats;
+using lms::internal::DebugServer;
+using lms::internal::TelemetryDecoder;
+using lms::internal::TelemetryEncoder;
+
+namespace {
+
+std::vector<TelemetryDecoder::Record> roundTrip(TelemetryEncoder &encoder) {
+    DebugServer::Datagram datagram = encoder.finish();
+    std::vector<TelemetryDecoder::Record> records;
+    const std::size_t header = 5;
+    EXPECT_TRUE(TelemetryDecoder::decode(datagram.data(), datagram.size() - header, records));
+    return records;
+}
+
+}  // namespace
+
+TEST(Telemetry, roundTrip) {
+    Time base = Time::fromMicros(1000000);
+    ChannelStats::Values values;
+    values.reads = 3;
+    values.bytes = 1024;
+    values.blockedMicros = 7;
+
+    TelemetryEncoder encoder;
+    encoder.mapping(4, "default.camera");
+    encoder.marker(TelemetryEncoder::BEGIN, base, 4, 1, 42);
+    encoder.marker(TelemetryEncoder::END, base + Time::fromMicros(250), 4, 1, 42);
+    encoder.channelStats(base + Time::fromMicros(300), 5, values);
+    encoder.counter(base - Time::fromMicros(10), 6, -12);
+    EXPECT_EQ(5u, encoder.records());
+
+    std::vector<TelemetryDecoder::Record> records = roundTrip(encoder);
+    ASSERT_EQ(5u, records.size());
+
+    EXPECT_EQ(TelemetryEncoder::MAPPING, records[0].kind);
+    EXPECT_EQ(4u, records[0].label);
+    EXPECT_EQ("default.camera", records[0].name);
+
+    EXPECT_EQ(TelemetryEncoder::END, records[2].kind);
+    EXPECT_EQ(base + Time::fromMicros(250), records[2].time);
+    EXPECT_EQ(1, records[2].thread);
+    EXPECT_EQ(42, records[2].cycle);
+
+    EXPECT_EQ(3u, records[3].values.reads);
+    EXPECT_EQ(1024u, records[3].values.bytes);
+    EXPECT_EQ(7, records[3].values.blockedMicros);
+
+    // records before the first one of the batch
+    EXPECT_EQ(base - Time::fromMicros(10), records[4].time);
+    EXPECT_EQ(-12, records[4].value);
+
+    // the encoder starts a new batch
+    EXPECT_EQ(0u, encoder.records());
+    encoder.counter(base, 6, 1);
+    EXPECT_EQ(1u, roundTrip(encoder).size());
+}
+
+TEST(Telemetry, rejectsTruncated) {
+    TelemetryEncoder encoder;
+    encoder.counter(Time::fromMicros(5), 1, 2);
+    DebugServer::Datagram datagram = encoder.finish();
+
+    std::vector<TelemetryDecoder::Record> records;
+    EXPECT_FALSE(TelemetryDecoder::decode(datagram.data(), datagram.size() - 6, records));
+}
@@ -0,0 +1,56 @@
+#include <memory>
+#include <new>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "lms/internal/thread_slot.h"
+
+using lms::internal::ThreadSlot;
+
+namespace {
+
+struct Owner {};
+
+typedef ThreadSlot<int, Owner> Slot;
+
+int get(Slot &slot, int &inits) {
+    return slot.get([&inits](int &value) {
+        value = ++inits;
+    });
+}
+
+}  // namespace
+
+TEST(ThreadSlot, perThread) {
+    Slot slot;
+    int inits = 0;
+
+    EXPECT_EQ(1, get(slot, inits));
+    EXPECT_EQ(1, get(slot, inits));
+
+    std::thread([&slot, &inits]() {
+        EXPECT_EQ(2, get(slot, inits));
+        EXPECT_EQ(2, get(slot, inits));
+    }).join();
+
+    EXPECT_EQ(1, get(slot, inits));
+}
+
+TEST(ThreadSlot, newInstance) {
+    int inits = 0;
+    Slot a;
+    Slot b;
+
+    EXPECT_EQ(1, get(a, inits));
+    EXPECT_EQ(2, get(b, inits));
+
+    // the cache only holds the slot that was used last
+    EXPECT_EQ(3, get(a, inits));
+
+    // a new slot at the same address is not taken for the old one
+    std::unique_ptr<Slot> slot(new Slot);
+    EXPECT_EQ(4, get(*slot, inits));
+    slot->~Slot();
+    new (slot.get()) Slot;
+    EXPECT_EQ(5, get(*slot, inits));
+}
@@ -0,0 +1,59 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#include "lms/internal/trace_profiler.h"
+
+using lms::internal::Profiler;
+using lms::internal::TraceProfiler;
+
+TEST(TraceProfiler, events) {
+    std::string file = "/tmp/lmstest_trace_" + std::to_string(getpid()) + ".json";
+
+    {
+        Profiler profiler;
+        profiler.appendListener(new TraceProfiler(file));
+
+        Profiler::LabelId runtime = profiler.label("default");
+        Profiler::LabelId module = profiler.label("default.camera");
+        Profiler::LabelId cycleTime = profiler.label("default.cycle time (us)");
+        Profiler::LabelId bytes = profiler.label("default.camera.allocated bytes");
+
+        Profiler::currentCycle(3);
+        profiler.markBegin(runtime);
+        profiler.markBegin(module);
+        profiler.markEnd(module);
+        profiler.markEnd(runtime);
+        profiler.counter(cycleTime, 42);
+        profiler.counter(bytes, 1024, Profiler::MODULE);
+
+        // module counters are not reported on level CYCLES
+        profiler.level(Profiler::Level::CYCLES);
+        profiler.applyLevel();
+        profiler.counter(bytes, 2048, Profiler::MODULE);
+    }
+
+    std::ifstream in(file);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string json = ss.str();
+
+    EXPECT_EQ('[', json.front());
+    EXPECT_EQ("]\n", json.substr(json.size() - 2));
+    EXPECT_NE(std::string::npos, json.find(
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"ts\":0,\"pid\":0,\"args\":{\"name\":\"default\"}}"));
+    EXPECT_NE(std::string::npos, json.find("\"name\":\"cycle\",\"ph\":\"B\""));
+    EXPECT_NE(std::string::npos, json.find("\"name\":\"camera\",\"ph\":\"E\""));
+    EXPECT_NE(std::string::npos, json.find("\"args\":{\"cycle\":3}"));
+    EXPECT_NE(std::string::npos, json.find("\"name\":\"cycle time (us)\",\"ph\":\"C\""));
+    EXPECT_NE(std::string::npos, json.find("\"args\":{\"cycle time (us)\":42}"));
+    EXPECT_NE(std::string::npos, json.find("\"name\":\"camera.allocated bytes\",\"ph\":\"C\""));
+    EXPECT_NE(std::string::npos, json.find("\"args\":{\"allocated bytes\":1024}"));
+    EXPECT_EQ(std::string::npos, json.find("2048"));
+
+    std::remove(file.c_str());
+}
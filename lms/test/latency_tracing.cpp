@@ -0,0 +1,119 @@
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "lms/module.h"
+#include "lms/extra/latency_histogram.h"
+#include "runtime_fixture.h"
+
+using lms::extra::LatencyHistogram;
+
+namespace {
+
+class Source : public lms::Module {
+public:
+    bool initialize() override {
+        raw = writeChannel<int>("RAW");
+        return true;
+    }
+
+    bool cycle() override {
+        *raw = cycleCounter();
+        return true;
+    }
+
+    bool deinitialize() override {
+        return true;
+    }
+
+    lms::WriteDataChannel<int> raw;
+};
+
+/**
+ * @brief Reads one channel and writes another one after a delay.
+ */
+class Filter : public lms::Module {
+public:
+    bool initialize() override {
+        input = readChannel<int>(config().get<std::string>("input"));
+        output = writeChannel<int>(config().get<std::string>("output"));
+        return true;
+    }
+
+    bool cycle() override {
+        int value = *input;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        *output = value;
+        return true;
+    }
+
+    bool deinitialize() override {
+        return true;
+    }
+
+    lms::ReadDataChannel<int> input;
+    lms::WriteDataChannel<int> output;
+};
+
+void filter(lms::internal::ModuleWrapper &wrapper, const std::string &input,
+            const std::string &output) {
+    wrapper.configs["default"].set<std::string>("input", input);
+    wrapper.configs["default"].set<std::string>("output", output);
+}
+
+}  // namespace
+
+typedef RuntimeFixture LatencyTracing;
+
+TEST_F(LatencyTracing, provenanceThroughModules) {
+    loadConfig("<framework>"
+               "<latency from=\"RAW\" to=\"CMD\"/>"
+               "<latency from=\"OBJ\" to=\"CMD\"/>"
+               "</framework>");
+
+    Runtime &rt = runtime("default");
+    addModule<Source>(rt, "source");
+    addModule<Filter>(rt, "detect", [](ModuleWrapper &wrapper) {
+        filter(wrapper, "RAW", "OBJ");
+    });
+    addModule<Filter>(rt, "plan", [](ModuleWrapper &wrapper) {
+        filter(wrapper, "OBJ", "CMD");
+    });
+
+    for(int i = 0; i < 3; i++) {
+        EXPECT_TRUE(rt.cycle());
+    }
+
+    // CMD inherits the origin of RAW through OBJ, both delays are included
+    LatencyHistogram hist;
+    ASSERT_TRUE(rt.dataManager().latency("RAW", "CMD", hist));
+    EXPECT_EQ(3u, hist.count());
+    EXPECT_GE(hist.min(), 4000);
+
+    // OBJ is not the oldest input of CMD
+    ASSERT_TRUE(rt.dataManager().latency("OBJ", "CMD", hist));
+    EXPECT_EQ(0u, hist.count());
+
+    EXPECT_FALSE(rt.dataManager().latency("RAW", "OBJ", hist));
+}
+
+TEST_F(LatencyTracing, provenanceFromRuntime) {
+    Runtime &producer = runtime("default");
+    Runtime &consumer = runtime("perception");
+    consumer.dataManager().traceLatency("RAW", "CMD");
+
+    addModule<Source>(producer, "source");
+    addModule<Filter>(consumer, "plan", [](ModuleWrapper &wrapper) {
+        filter(wrapper, "RAW", "CMD");
+        wrapper.channelRuntimes["RAW"] = "default";
+    });
+
+    EXPECT_TRUE(producer.cycle());
+    EXPECT_TRUE(consumer.cycle());
+
+    // the origin is handed over with the imported value
+    LatencyHistogram hist;
+    ASSERT_TRUE(consumer.dataManager().latency("RAW", "CMD", hist));
+    EXPECT_EQ(1u, hist.count());
+    EXPECT_GE(hist.min(), 2000);
+}
@@ -0,0 +1,159 @@
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "lms/logging/context.h"
+#include "lms/logging/event.h"
+#include "lms/logging/sink.h"
+
+namespace {
+
+using lms::logging::Context;
+using lms::logging::Event;
+using lms::logging::Level;
+
+/* records all messages, blocks in sink() until released */
+class RecordingSink : public lms::logging::Sink {
+public:
+    RecordingSink(std::vector<std::string> &messages, std::atomic<bool> &released,
+                  std::atomic<bool> &entered)
+        : m_messages(messages), m_released(released), m_entered(entered) {}
+
+    void sink(const Event &message) override {
+        m_entered = true;
+        while(! m_released) {
+            std::this_thread::yield();
+        }
+        m_messages.push_back(message.messageText());
+    }
+private:
+    std::vector<std::string> &m_messages;
+    std::atomic<bool> &m_released;
+    std::atomic<bool> &m_entered;
+};
+
+void log(Context &ctx, Level level, int i) {
+    Event event(ctx, level, "test");
+    event.messageStream << i;
+}
+
+}  // namespace
+
+TEST(Context, asyncFlush) {
+    std::vector<std::string> messages;
+    std::atomic<bool> released(true), entered(false);
+
+    Context ctx;
+    ctx.appendSink(new RecordingSink(messages, released, entered));
+    ctx.async(true, 16);
+    EXPECT_TRUE(ctx.async());
+
+    // more events than the queue holds, BLOCK must not lose any
+    for(int i = 0; i < 100; i++) {
+        log(ctx, Level::INFO, i);
+    }
+    ctx.flush();
+
+    ASSERT_EQ(100u, messages.size());
+    EXPECT_EQ("0", messages.front());
+    EXPECT_EQ("99", messages.back());
+    EXPECT_EQ(0u, ctx.dropped());
+
+    ctx.async(false);
+    EXPECT_FALSE(ctx.async());
+}
+
+TEST(Context, asyncDropNewest) {
+    std::vector<std::string> messages;
+    std::atomic<bool> released(false), entered(false);
+
+    Context ctx;
+    ctx.appendSink(new RecordingSink(messages, released, entered));
+    ctx.async(true, 4, Context::OverflowPolicy::DROP_NEWEST);
+
+    // stall the background thread in the sink
+    log(ctx, Level::INFO, 0);
+    while(! entered) {
+        std::this_thread::yield();
+    }
+
+    for(int i = 1; i <= 10; i++) {
+        log(ctx, Level::WARN, i);
+    }
+    EXPECT_EQ(6u, ctx.dropped());
+    EXPECT_EQ(6u, ctx.dropped(Level::WARN));
+
+    released = true;
+    ctx.async(false);
+    ASSERT_EQ(5u, messages.size());
+    EXPECT_EQ("4", messages.back());
+}
+
+TEST(Context, asyncDropDebugFirst) {
+    std::vector<std::string> messages;
+    std::atomic<bool> released(false), entered(false);
+
+    Context ctx;
+    ctx.appendSink(new RecordingSink(messages, released, entered));
+    ctx.async(true, 4, Context::OverflowPolicy::DROP_DEBUG_FIRST);
+
+    log(ctx, Level::INFO, 0);
+    while(! entered) {
+        std::this_thread::yield();
+    }
+
+    // debug events fit until the queue is 3/4 full
+    for(int i = 1; i <= 5; i++) {
+        log(ctx, Level::DEBUG, i);
+    }
+    EXPECT_EQ(2u, ctx.dropped(Level::DEBUG));
+
+    // the last slot is kept for more important events
+    log(ctx, Level::ERROR, 6);
+    log(ctx, Level::ERROR, 7);
+    EXPECT_EQ(1u, ctx.dropped(Level::ERROR));
+
+    released = true;
+    ctx.async(false);
+    ASSERT_EQ(5u, messages.size());
+    EXPECT_EQ("6", messages.back());
+}
+
+TEST(Context, asyncOffWhileLogging) {
+    /* counts messages of several threads */
+    class CountingSink : public lms::logging::Sink {
+    public:
+        explicit CountingSink(std::atomic<int> &count) : m_count(count) {}
+        void sink(const Event &) override {
+            m_count++;
+        }
+    private:
+        std::atomic<int> &m_count;
+    };
+
+    std::atomic<int> count(0);
+    Context ctx;
+    ctx.appendSink(new CountingSink(count));
+    ctx.async(true, 4, Context::OverflowPolicy::BLOCK);
+
+    // a full queue must neither lose events nor block the producers forever
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 3; t++) {
+        threads.emplace_back([&ctx]() {
+            for(int i = 0; i < 2000; i++) {
+                log(ctx, Level::INFO, i);
+            }
+        });
+    }
+    std::this_thread::yield();
+    ctx.async(false);
+
+    for(auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(6000, count.load());
+    EXPECT_EQ(0u, ctx.dropped());
+}
@@ -0,0 +1,106 @@
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lms/logger.h"
+#include "lms/internal/allocation_tracker.h"
+#include "../allocation_counter.h"
+
+namespace {
+
+using lms::logging::Level;
+
+/* keeps the last message without allocating after the first one */
+class LastSink : public lms::logging::Sink {
+public:
+    LastSink(std::string &tag, std::string &text) : m_tag(tag), m_text(text) {}
+
+    void sink(const lms::logging::Event &message) override {
+        m_tag.assign(message.tag);
+        m_text.assign(message.messageText());
+    }
+private:
+    std::string &m_tag;
+    std::string &m_text;
+};
+
+}  // namespace
+
+TEST(Event, reusedStorage) {
+    std::string tag, text;
+    lms::logging::Context ctx;
+    ctx.appendSink(new LastSink(tag, text));
+    lms::logging::Logger logger(&ctx, "module");
+
+    logger.info("tag") << std::hex << 255 << " " << std::string(300, 'x');
+    EXPECT_EQ("module.tag", tag);
+    EXPECT_EQ("ff " + std::string(300, 'x'), text);
+
+    // stream state and text of the previous message are gone
+    logger.info() << 255;
+    EXPECT_EQ("module", tag);
+    EXPECT_EQ("255", text);
+
+    logger.warn() << "a" << std::endl << "b";
+    EXPECT_EQ("b", text);
+}
+
+namespace {
+
+void expectNoAllocations(bool async) {
+    using lms::internal::AllocationTracker;
+    if(! lmstest::countsAllocations()) {
+        GTEST_SKIP() << "operator new is not replaced";
+    }
+
+    std::string tag, text;
+    lms::logging::Context ctx;
+    ctx.appendSink(new LastSink(tag, text));
+    if(async) {
+        ctx.async(true, 16);
+    }
+    lms::logging::Logger logger(&ctx, "perception.consumer", Level::INFO);
+    tag.reserve(128);
+    text.reserve(128);
+
+    // warm up the storage of this thread
+    logger.info("frame") << "seq " << 1 << " x " << 0.5;
+
+    AllocationTracker::Counters counters;
+    AllocationTracker::attach(&counters);
+    for(int i = 0; i < 100; i++) {
+        logger.info("frame") << "seq " << i << " x " << i * 0.5;
+        logger.debug("frame") << "disabled " << i;
+    }
+    AllocationTracker::attach(nullptr);
+    ctx.flush();
+
+    EXPECT_EQ(0u, counters.allocations);
+    EXPECT_EQ("perception.consumer.frame", tag);
+    EXPECT_EQ("seq 99 x 49.5", text);
+}
+
+}  // namespace
+
+TEST(Event, noAllocations) {
+    expectNoAllocations(false);
+}
+
+TEST(Event, noAllocationsAsync) {
+    // the background thread is not counted, only the logging thread
+    expectNoAllocations(true);
+}
+
+TEST(Event, asyncLongMessage) {
+    std::string tag, text;
+    lms::logging::Context ctx;
+    ctx.appendSink(new LastSink(tag, text));
+    ctx.async(true, 16);
+
+    lms::logging::Logger logger(&ctx, "module");
+    logger.info("tag") << std::string(1000, 'x');
+    ctx.async(false);
+
+    EXPECT_EQ("module.tag", tag);
+    EXPECT_EQ(std::string(1000, 'x'), text);
+}
@@ -0,0 +1,246 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "lms/messaging.h"
+#include "runtime_fixture.h"
+
+using lms::Messaging;
+
+TEST(Messaging, commandIds) {
+    Messaging messaging;
+
+    Messaging::CommandId a = messaging.command("a");
+    Messaging::CommandId b = messaging.command("b");
+
+    EXPECT_NE(a, b);
+    EXPECT_EQ(a, messaging.command("a"));
+}
+
+TEST(Messaging, receiveInNextCycle) {
+    Messaging messaging;
+    Messaging::CommandId stop = messaging.command("stop");
+
+    messaging.send(stop, "now");
+    messaging.send("speed", "1");
+    messaging.send("speed", "2");
+
+    // nothing can be received in the same cycle
+    EXPECT_TRUE(messaging.receive(stop).empty());
+
+    messaging.resetQueue();
+
+    Messaging::MessageView stops = messaging.receive(stop);
+    ASSERT_EQ(1u, stops.size());
+    EXPECT_EQ("now", stops.front());
+
+    Messaging::MessageView speeds = messaging.receive("speed");
+    ASSERT_EQ(2u, speeds.size());
+    EXPECT_EQ("1", speeds[0]);
+    EXPECT_EQ("2", speeds[1]);
+
+    EXPECT_TRUE(messaging.receive("unknown").empty());
+
+    // messages live for one cycle only
+    messaging.resetQueue();
+    EXPECT_TRUE(messaging.receive(stop).empty());
+    EXPECT_TRUE(messaging.receive("speed").empty());
+}
+
+TEST(Messaging, workers) {
+    Messaging messaging;
+    messaging.workers(3);
+    Messaging::CommandId cmd = messaging.command("cmd");
+
+    std::thread threads[3];
+    for(int i = 0; i < 3; i++) {
+        threads[i] = std::thread([&messaging, cmd, i]() {
+            Messaging::currentWorker(i);
+            for(int k = 0; k < 100; k++) {
+                messaging.send(cmd, std::to_string(i));
+            }
+        });
+    }
+    for(std::thread &th : threads) {
+        th.join();
+    }
+
+    // not a worker thread
+    messaging.send(cmd, "main");
+
+    messaging.resetQueue();
+
+    Messaging::MessageView msgs = messaging.receive(cmd);
+    ASSERT_EQ(301u, msgs.size());
+
+    int counts[3] = {0, 0, 0};
+    int main = 0;
+    for(std::string const& msg : msgs) {
+        if(msg == "main") {
+            main++;
+        } else {
+            counts[std::stoi(msg)]++;
+        }
+    }
+    EXPECT_EQ(1, main);
+    EXPECT_EQ(100, counts[0]);
+    EXPECT_EQ(100, counts[1]);
+    EXPECT_EQ(100, counts[2]);
+}
+
+namespace {
+
+struct Twist {
+    double linear;
+    double angular;
+};
+
+struct Path : public lms::Serializable {
+    std::vector<int> points;
+
+    void lmsSerialize(std::ostream &os) const override {
+        os << points.size();
+        for(int p : points) {
+            os << " " << p;
+        }
+    }
+
+    void lmsDeserialize(std::istream &is) override {
+        std::size_t size;
+        is >> size;
+        points.resize(size);
+        for(int &p : points) {
+            is >> p;
+        }
+    }
+};
+
+}  // namespace
+
+TEST(Messaging, payloads) {
+    Messaging messaging;
+    Messaging::CommandId cmd = messaging.command("cmd");
+
+    Twist twist = {1.5, -0.5};
+    messaging.sendPayload(cmd, twist);
+    twist.linear = 3;
+    messaging.sendPayload(cmd, twist);
+    messaging.sendPayload(cmd, 'x');
+
+    Path path;
+    path.points = {4, 5, 6};
+    messaging.sendPayload(cmd, path);
+    messaging.send(cmd, "text");
+
+    messaging.resetQueue();
+
+    // strings and payloads are received separately
+    ASSERT_EQ(1u, messaging.receive(cmd).size());
+
+    Messaging::PayloadView payloads = messaging.receivePayloads(cmd);
+    ASSERT_EQ(4u, payloads.size());
+
+    ASSERT_TRUE(payloads[0].is<Twist>());
+    EXPECT_EQ(1.5, payloads[0].get<Twist>()->linear);
+    EXPECT_EQ(-0.5, payloads[0].get<Twist>()->angular);
+    EXPECT_EQ(3, payloads[1].get<Twist>()->linear);
+
+    // wrong type
+    EXPECT_EQ(nullptr, payloads[2].get<Twist>());
+    EXPECT_EQ('x', *payloads[2].get<char>());
+
+    Path received;
+    EXPECT_FALSE(payloads[0].deserialize(received));
+    ASSERT_TRUE(payloads[3].deserialize(received));
+    EXPECT_EQ(path.points, received.points);
+
+    for(Messaging::Payload const& payload : payloads) {
+        EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(payload.data()) % alignof(Twist));
+    }
+
+    messaging.resetQueue();
+    EXPECT_TRUE(messaging.receivePayloads(cmd).empty());
+}
+
+TEST(Messaging, subscriptions) {
+    Messaging messaging;
+    Messaging::CommandId cmd = messaging.command("cmd");
+
+    Messaging::Subscription sub = messaging.subscribe(cmd, 4);
+    Messaging::Subscription other = messaging.subscribe("other");
+    ASSERT_TRUE(static_cast<bool>(sub));
+
+    for(int i = 0; i < 3; i++) {
+        messaging.send(cmd, std::to_string(i));
+    }
+    messaging.resetQueue();
+
+    // messages persist across cycles until popped
+    messaging.resetQueue();
+    EXPECT_EQ(3u, sub.size());
+    EXPECT_EQ(0u, other.size());
+
+    std::string content;
+    ASSERT_TRUE(sub.pop(content));
+    EXPECT_EQ("0", content);
+
+    // the queue holds 4 messages, 2 are queued
+    for(int i = 3; i < 6; i++) {
+        messaging.send(cmd, std::to_string(i));
+    }
+    messaging.resetQueue();
+    EXPECT_EQ(1u, sub.dropped());
+
+    std::vector<std::string> contents;
+    EXPECT_EQ(4u, sub.popAll(contents));
+    EXPECT_EQ((std::vector<std::string>{"1", "2", "3", "4"}), contents);
+    EXPECT_FALSE(sub.pop(content));
+
+    Messaging::Subscription empty;
+    EXPECT_FALSE(static_cast<bool>(empty));
+    EXPECT_FALSE(empty.pop(content));
+}
+
+namespace {
+
+class SendingModule : public lms::Module {
+public:
+    SendingModule() : workers(0) {}
+
+    bool initialize() override {
+        return true;
+    }
+
+    bool cycle() override {
+        workers = messaging()->workers();
+        messaging()->send("cmd", "hello");
+        return true;
+    }
+
+    bool deinitialize() override {
+        return true;
+    }
+
+    int workers;
+};
+
+}  // namespace
+
+typedef RuntimeFixture MessagingRuntime;
+
+TEST_F(MessagingRuntime, singleThreaded) {
+    Runtime &rt = runtime("default");
+    ASSERT_FALSE(rt.executionManager().enabledMultithreading());
+    SendingModule *sender = addModule<SendingModule>(rt, "sender");
+
+    EXPECT_TRUE(rt.cycle());
+    // the main thread got its own send buffer, no shared lock is taken
+    EXPECT_EQ(1, sender->workers);
+
+    EXPECT_TRUE(rt.cycle());
+    Messaging::MessageView received = rt.executionManager().messaging().receive("cmd");
+    ASSERT_EQ(1u, received.size());
+    EXPECT_EQ("hello", received.front());
+}
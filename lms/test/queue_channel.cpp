@@ -0,0 +1,111 @@
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lms/module.h"
+#include "runtime_fixture.h"
+
+namespace {
+
+class QueueWriter : public lms::Module {
+public:
+    QueueWriter() : capacity(0), dropped(0), next(0) {}
+
+    bool initialize() override {
+        queue = writeQueue<int>("CAN");
+        capacity = queue.capacity();
+        return true;
+    }
+
+    bool cycle() override {
+        for(int i = 0; i < 3; i++) {
+            if(! queue.push(next++)) {
+                dropped++;
+            }
+        }
+        return true;
+    }
+
+    bool deinitialize() override {
+        return true;
+    }
+
+    lms::WriteQueueChannel<int> queue;
+    std::size_t capacity;
+    int dropped;
+    int next;
+};
+
+class QueueReader : public lms::Module {
+public:
+    bool initialize() override {
+        queue = readQueue<int>("CAN");
+        return true;
+    }
+
+    bool cycle() override {
+        queue.popAll(received);
+        return true;
+    }
+
+    bool deinitialize() override {
+        return true;
+    }
+
+    lms::ReadQueueChannel<int> queue;
+    std::vector<int> received;
+};
+
+}  // namespace
+
+typedef RuntimeFixture QueueChannel;
+
+TEST_F(QueueChannel, capacityFromConfig) {
+    loadConfig("<framework><channel name=\"CAN\" queueCapacity=\"4\"/></framework>");
+
+    Runtime &rt = runtime("default");
+    QueueWriter *writer = addModule<QueueWriter>(rt, "writer");
+    QueueReader *reader = addModule<QueueReader>(rt, "reader");
+
+    EXPECT_EQ(4u, writer->capacity);
+
+    // the reader runs after the writer and pops all items of the cycle
+    EXPECT_TRUE(rt.cycle());
+    EXPECT_EQ(std::vector<int>({0, 1, 2}), reader->received);
+    EXPECT_EQ(0u, reader->queue.size());
+    EXPECT_EQ(0, writer->dropped);
+}
+
+TEST_F(QueueChannel, dropWhenFull) {
+    loadConfig("<framework><channel name=\"CAN\" queueCapacity=\"4\"/></framework>");
+
+    Runtime &rt = runtime("default");
+    QueueWriter *writer = addModule<QueueWriter>(rt, "writer");
+
+    EXPECT_TRUE(rt.cycle());
+    EXPECT_TRUE(rt.cycle());
+    EXPECT_EQ(2, writer->dropped);
+}
+
+TEST_F(QueueChannel, importFromRuntime) {
+    loadConfig("<framework><channel name=\"CAN\" queueCapacity=\"16\"/></framework>");
+
+    Runtime &producer = runtime("default");
+    Runtime &consumer = runtime("perception");
+    addModule<QueueWriter>(producer, "writer");
+    QueueReader *reader = addModule<QueueReader>(consumer, "reader",
+        [](ModuleWrapper &wrapper) {
+            wrapper.channelRuntimes["CAN"] = "default";
+        });
+
+    // the handle is published after the producer's cycle and imported
+    // before the consumer's cycle
+    EXPECT_TRUE(producer.cycle());
+    EXPECT_TRUE(consumer.cycle());
+    EXPECT_EQ(std::vector<int>({0, 1, 2}), reader->received);
+
+    // the consumer pops from the producer's queue, nothing is copied
+    reader->received.clear();
+    EXPECT_TRUE(producer.cycle());
+    EXPECT_TRUE(consumer.cycle());
+    EXPECT_EQ(std::vector<int>({3, 4, 5}), reader->received);
+}
@@ -0,0 +1,100 @@
+#ifndef LMS_TEST_RUNTIME_FIXTURE_H
+#define LMS_TEST_RUNTIME_FIXTURE_H
+
+#include <memory>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <functional>
+
+#include "gtest/gtest.h"
+#include "lms/module.h"
+#include "lms/internal/framework.h"
+#include "lms/internal/runtime.h"
+#include "lms/internal/module_wrapper.h"
+#include "lms/internal/xml_parser.h"
+
+/**
+ * @brief Framework without configs that tests add runtimes and modules to.
+ *
+ * Modules are created by loader factories instead of being loaded from a
+ * library. Cycles are run by calling Runtime::cycle().
+ */
+class RuntimeFixture : public ::testing::Test {
+protected:
+    typedef lms::internal::Runtime Runtime;
+    typedef lms::internal::ModuleWrapper ModuleWrapper;
+
+    virtual void SetUp() override {
+        m_arguments.argRunLevel = lms::internal::RunLevel::CONFIG;
+        m_arguments.argQuiet = true;
+        m_arguments.configPath = "/nonexistent";
+        m_framework.reset(new lms::internal::Framework(m_arguments));
+    }
+
+    virtual void TearDown() override {
+        m_framework.reset();
+    }
+
+    /**
+     * @brief Return the runtime with the given name, create it if needed.
+     */
+    Runtime& runtime(const std::string &name) {
+        if(! m_framework->hasRuntime(name)) {
+            m_framework->registerRuntime(new Runtime(name, *m_framework));
+        }
+        return *m_framework->getRuntimeByName(name);
+    }
+
+    /**
+     * @brief Parse the given framework config into the default runtime, the
+     * same way the framework parses framework_conf.xml.
+     */
+    void loadConfig(const std::string &xml) {
+        std::string name = std::string("lmstest_") +
+            ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        std::string file = "/tmp/" + name + ".xml";
+        {
+            std::ofstream ofs(file);
+            ofs << xml;
+        }
+
+        lms::internal::XmlParser parser(*m_framework, &runtime("default"), m_arguments);
+        parser.parseConfig(lms::internal::XmlParser::LoadConfigFlag::LOAD_EVERYTHING,
+                           name, "/tmp");
+        std::remove(file.c_str());
+
+        for(std::string const& error : parser.errors()) {
+            ADD_FAILURE() << error;
+        }
+    }
+
+    /**
+     * @brief Create, initialize and enable a module of type M.
+     * @param setup called with the wrapper before the module is initialized,
+     * e.g. to set channel mappings or configs
+     * @return the module, owned by its wrapper
+     */
+    template<typename M>
+    M* addModule(Runtime &rt, const std::string &name,
+                 std::function<void(ModuleWrapper&)> setup = nullptr) {
+        std::shared_ptr<ModuleWrapper> wrapper = std::make_shared<ModuleWrapper>(&rt);
+        wrapper->name(name);
+        wrapper->libname("lmstest." + name);
+        if(setup) {
+            setup(*wrapper);
+        }
+
+        m_framework->moduleLoader().addFactory(wrapper->libname(), []() -> lms::Module* {
+            return new M;
+        });
+        EXPECT_TRUE(rt.executionManager().installModule(wrapper));
+        EXPECT_TRUE(rt.executionManager().enableModule(name));
+        return static_cast<M*>(wrapper->instance());
+    }
+
+    lms::internal::ArgumentHandler m_arguments;
+    std::unique_ptr<lms::internal::Framework> m_framework;
+};
+
+#endif // LMS_TEST_RUNTIME_FIXTURE_H
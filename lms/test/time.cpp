@@ -3,6 +3,29 @@
 #include "gtest/gtest.h"
 #include "lms/time.h"
 
+TEST(Time, threadCpuTime) {
+    using lms::Time;
+
+    Time cpuStart = Time::threadCpuTime();
+    Time wallStart = Time::now();
+
+    // sleeping does not use CPU time
+    Time::fromMillis(20).sleep();
+
+    Time cpu = Time::threadCpuTime() - cpuStart;
+    Time wall = Time::now() - wallStart;
+    EXPECT_GE(wall, Time::fromMillis(20));
+    EXPECT_LT(cpu, Time::fromMillis(10));
+
+    // busy waiting does
+    cpuStart = Time::threadCpuTime();
+    volatile std::uint64_t sum = 0;
+    while(Time::threadCpuTime() - cpuStart < Time::fromMillis(5)) {
+        sum += 1;
+    }
+    EXPECT_GE(Time::threadCpuTime() - cpuStart, Time::fromMillis(5));
+}
+
 TEST(Time, fromMicros) {
     using lms::Time;
 